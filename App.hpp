@@ -2,6 +2,7 @@
 
 #include "Logger.hpp"
 #include "EWHAT.hpp"
+#include "Metrics.hpp"
 
 template<typename L, typename A>
 class App {
@@ -17,6 +18,7 @@ protected:
     int run() {
         try {
             createLogger<L>();
+            MetricsTimer timer(metrics().histogram("app_process_ns", "App::process() run time in nanoseconds"));
             result = process();
         } catch (exception &e) {
             LOG_ERROR("Exception" + EWHAT);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+#include <iomanip>
+#include "Stopper.hpp"
+#include "str_contains.hpp"
+#include "F.hpp"
+
+using namespace std;
+
+// Keeps the optimizer from dropping a benchmarked result
+#define BENCH_KEEP(var) asm volatile("" : : "g"(&(var)) : "memory")
+
+typedef void (*Bench)(size_t iterations);
+
+class Benchmarker {
+public:
+
+    virtual ~Benchmarker() {}
+
+    void add(const string& info, Bench bench, size_t iterations) {
+        benches[info] = { bench, iterations };
+    }
+
+    void run(vector<string> filters = {}) {
+        cout << "Benchmark(s) are running..." << endl;
+        for (const auto& [info, bench]: benches) {
+            bool skipp = !filters.empty();
+            for (const string& filter: filters)
+                if (str_contains(info, filter)) skipp = false;
+            if (skipp) continue;
+
+            Stopper stopper;
+            bench.first(bench.second);
+            double ms = stopper.stop();
+            cout << F(F_FUNC, info) << ": " 
+                << bench.second << " iteration(s), "
+                << fixed << setprecision(3) << ms << " ms, " 
+                << setprecision(1) << (ms * 1'000'000.0 / (double)bench.second) << " ns/iteration" << endl;
+        }
+    }
+
+private:
+    map<string, pair<Bench, size_t>> benches;
+} benchmarker;
+
+#define BENCH(name, count) \
+void name(size_t); \
+struct struct_of_##name { \
+    struct_of_##name() { \
+        benchmarker.add(#name, name, (count)); \
+    } \
+} instance_of_##name; \
+void name(size_t iterations)
@@ -24,6 +24,7 @@ public:
     }
 
     ~ClogLogger() {
+        shutdown();
         // Restore original clog buffer
         clog.rdbuf(original_buffer);
         if (file.is_open()) {
@@ -0,0 +1,253 @@
+#pragma once
+
+#include "ERROR.hpp"
+#include "MappedVector.hpp"
+#include "mkdir.hpp"
+#include <vector>
+#include <string>
+#include <span>
+#include <algorithm>
+#include <type_traits>
+#include <bit>
+#include <random>
+#include <thread>
+
+using namespace std;
+
+enum ColumnEncoding: uint8_t {
+    COLUMN_RAW = 0,
+    COLUMN_DELTA_PACKED = 1, // integers (time_ms too): zigzag deltas bit packed to the widest one
+};
+
+// Block index entry of a column, min and max let readers skip blocks unread
+template<typename T>
+struct ColumnBlock {
+    uint64_t row;      // first row
+    uint64_t offset;   // byte offset in the data file
+    uint32_t rows;
+    uint8_t encoding;  // ColumnEncoding
+    uint8_t bits;      // delta width when packed
+    T min, max;
+    T first;           // packed blocks: the first value, the deltas follow
+};
+
+// Pairs the two files of a column write, 0 is left for untagged files
+inline uint64_t column_generation() {
+    static thread_local mt19937_64 random(random_device{}());
+    uint64_t generation;
+    do generation = random(); while (!generation);
+    return generation;
+}
+
+// Columnar dataset: a directory with two mapped vector files per column,
+// <name>.index (the ColumnBlock entries) and <name>.data (the blocks).
+// Each column is written and mapped on its own, so scanning one field
+// reads only that field, and only the blocks the row range or the value
+// range needs. Both files of a write carry the same generation tag, a
+// reader opening them between the two renames sees different tags and
+// opens them again.
+//   column_save("ticks", "time", ticks, &Tick::time, COLUMN_DELTA_PACKED);
+//   column_save("ticks", "price", ticks, &Tick::price);
+//   ColumnReader<float> prices("ticks", "price");
+//   vector<float> last = prices.read(prices.rows() - 1000, prices.rows());
+template<typename T>
+void column_save(const string& dir, const string& name, span<const T> values, ColumnEncoding encoding = COLUMN_RAW, size_t block_rows = 65536) {
+    static_assert(is_trivially_copyable_v<T>, "column_save() needs a trivially copyable T");
+    if (encoding == COLUMN_DELTA_PACKED && !is_integral_v<T>)
+        throw ERROR("Delta packing needs an integer column: " + name);
+    if (!block_rows || block_rows > UINT32_MAX)
+        throw ERROR("Invalid column block size: " + to_string(block_rows));
+    if (!mkdir(dir, 0777, true))
+        throw ERROR("Unable to create column directory: " + dir);
+
+    constexpr size_t align = max<size_t>(8, alignof(T));
+    vector<ColumnBlock<T>> blocks;
+    vector<char> data;
+    vector<uint64_t> zigzags;
+    for (size_t row = 0; row < values.size(); row += block_rows) {
+        span<const T> part = values.subspan(row, min(block_rows, values.size() - row));
+        ColumnBlock<T> block = {};
+        block.row = row;
+        block.rows = part.size();
+        block.min = block.max = block.first = part[0];
+        for (const T& v: part) {
+            if (v < block.min) block.min = v;
+            if (block.max < v) block.max = v;
+        }
+        data.resize((data.size() + align - 1) / align * align);
+        block.offset = data.size();
+        block.encoding = COLUMN_RAW;
+        if constexpr (is_integral_v<T>) {
+            if (encoding == COLUMN_DELTA_PACKED) {
+                // modulo 2^64 differences, exact for any integer up to 64 bits
+                zigzags.resize(part.size() - 1);
+                uint64_t widest = 0;
+                for (size_t i = 1; i < part.size(); i++) {
+                    int64_t delta = (int64_t)((uint64_t)part[i] - (uint64_t)part[i - 1]);
+                    zigzags[i - 1] = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+                    widest |= zigzags[i - 1];
+                }
+                block.bits = bit_width(widest);
+                size_t words = (zigzags.size() * block.bits + 63) / 64;
+                if (words * 8 < part.size_bytes()) {
+                    block.encoding = COLUMN_DELTA_PACKED;
+                    data.resize(data.size() + words * 8);
+                    char* out = data.data() + block.offset;
+                    uint64_t word = 0;
+                    size_t used = 0, w = 0;
+                    for (uint64_t z: zigzags) {
+                        word |= z << used;
+                        if (used + block.bits >= 64) {
+                            memcpy(out + 8 * w++, &word, 8);
+                            word = used ? z >> (64 - used) : 0;
+                            used = used + block.bits - 64;
+                        } else used += block.bits;
+                    }
+                    if (used) memcpy(out + 8 * w, &word, 8);
+                }
+            }
+        }
+        if (block.encoding == COLUMN_RAW) {
+            data.resize(data.size() + part.size_bytes());
+            memcpy(data.data() + block.offset, part.data(), part.size_bytes());
+        }
+        blocks.push_back(block);
+    }
+    string path = dir + "/" + name;
+    uint64_t generation = column_generation();
+    vector_save_mapped(data, path + ".data", generation);
+    vector_save_mapped(blocks, path + ".index", generation);
+}
+
+template<typename T>
+void column_save(const string& dir, const string& name, const vector<T>& values, ColumnEncoding encoding = COLUMN_RAW, size_t block_rows = 65536) {
+    column_save(dir, name, span<const T>(values), encoding, block_rows);
+}
+
+// One field of a vector of records as a column
+template<typename R, typename T>
+void column_save(const string& dir, const string& name, const vector<R>& records, T R::* field, ColumnEncoding encoding = COLUMN_RAW, size_t block_rows = 65536) {
+    vector<T> values;
+    values.reserve(records.size());
+    for (const R& record: records) values.push_back(record.*field);
+    column_save(dir, name, span<const T>(values), encoding, block_rows);
+}
+
+// Reads a column written by column_save(), both files are mapped, blocks are
+// decoded only when a read or a scan reaches them
+template<typename T>
+class ColumnReader {
+public:
+    // Throws when the index and the data stay from different writes
+    ColumnReader(const string& dir, const string& name, bool populate = false):
+        index(dir + "/" + name + ".index", populate),
+        data(dir + "/" + name + ".data", populate)
+    {
+        for (int attempt = 1; index.tag() != data.tag(); attempt++) {
+            if (attempt == 10)
+                throw ERROR("Column index and data are from different writes: " + dir + "/" + name);
+            this_thread::sleep_for(chrono::milliseconds(1)); // a writer is between its two renames
+            index = MappedVector<ColumnBlock<T>>(dir + "/" + name + ".index", populate);
+            data = MappedVector<char>(dir + "/" + name + ".data", populate);
+        }
+    }
+
+    size_t rows() const {
+        return index.empty() ? 0 : index[index.size() - 1].row + index[index.size() - 1].rows;
+    }
+
+    span<const ColumnBlock<T>> blocks() const {
+        return index.view();
+    }
+
+    // Rows [from, to) appended to out
+    void read(size_t from, size_t to, vector<T>& out) const {
+        if (from > to || to > rows())
+            throw ERROR("Column row range out of bounds: " + to_string(from) + ".." + to_string(to) + " of " + to_string(rows()));
+        if (from == to) return;
+        size_t at = out.size();
+        out.resize(at + to - from);
+        size_t b = block_of(from);
+        for (size_t row = from; row < to; b++) {
+            const ColumnBlock<T>& block = index[b];
+            size_t skip = row - block.row;
+            size_t count = min<size_t>(block.rows - skip, to - row);
+            if (block.encoding == COLUMN_RAW)
+                memcpy(out.data() + at, data.data() + block.offset + skip * sizeof(T), count * sizeof(T));
+            else {
+                const T* values = decode(b);
+                copy(values + skip, values + skip + count, out.begin() + at);
+            }
+            at += count;
+            row += count;
+        }
+    }
+
+    vector<T> read(size_t from, size_t to) const {
+        vector<T> out;
+        read(from, to, out);
+        return out;
+    }
+
+    // Calls found(row, value) for every value in [lo, hi], the blocks whose
+    // min/max are outside of the range are not read at all
+    template<typename F>
+    size_t scan(T lo, T hi, F found) const {
+        size_t matches = 0;
+        for (size_t b = 0; b < index.size(); b++) {
+            const ColumnBlock<T>& block = index[b];
+            if (block.max < lo || hi < block.min) continue;
+            const T* values = block.encoding == COLUMN_RAW ? (const T*)(data.data() + block.offset) : decode(b);
+            for (size_t i = 0; i < block.rows; i++)
+                if (!(values[i] < lo) && !(hi < values[i])) {
+                    found(block.row + i, values[i]);
+                    matches++;
+                }
+        }
+        return matches;
+    }
+
+private:
+    size_t block_of(size_t row) const {
+        auto it = upper_bound(index.begin(), index.end(), row, [](size_t r, const ColumnBlock<T>& block) {
+            return r < block.row;
+        });
+        return it - index.begin() - 1;
+    }
+
+    // The last decoded block is kept, reads walking through a block decode it
+    // once. Kept by index: blocks without deltas (bits 0) take no data bytes,
+    // so the next block starts at the same offset
+    const T* decode(size_t b) const {
+        if (decoded_block == b) return decoded.data();
+        const ColumnBlock<T>& block = index[b];
+        if constexpr (is_integral_v<T>) {
+            vector<T>& out = decoded;
+            out.resize(block.rows);
+            const char* in = data.data() + block.offset;
+            uint64_t mask = block.bits == 64 ? ~0ull : (1ull << block.bits) - 1;
+            uint64_t v = (uint64_t)block.first;
+            out[0] = block.first;
+            size_t bit = 0;
+            for (size_t i = 1; i < block.rows; i++, bit += block.bits) {
+                uint64_t z = 0;
+                if (block.bits) {
+                    uint64_t lo, hi = 0;
+                    memcpy(&lo, in + (bit / 64) * 8, 8);
+                    size_t shift = bit % 64;
+                    if (shift + block.bits > 64) memcpy(&hi, in + (bit / 64 + 1) * 8, 8);
+                    z = ((lo >> shift) | (shift ? hi << (64 - shift) : 0)) & mask;
+                }
+                v += (z >> 1) ^ (0 - (z & 1));
+                out[i] = (T)v;
+            }
+            decoded_block = b;
+            return out.data();
+        } else throw ERROR("Delta packed block in a non integer column");
+    }
+
+    MappedVector<ColumnBlock<T>> index;
+    MappedVector<char> data;
+    mutable vector<T> decoded; // not thread safe, one reader per thread
+    mutable size_t decoded_block = SIZE_MAX;
+};
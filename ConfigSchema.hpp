@@ -0,0 +1,176 @@
+#pragma once
+
+#include "JSON.hpp"
+#include "IniData.hpp"
+#include "Arguments.hpp"
+#include "ERROR.hpp"
+#include "implode.hpp"
+#include <tuple>
+#include <optional>
+#include <memory>
+#include <atomic>
+
+using namespace std;
+
+// One member of a config struct: where it is read from, its default and its check.
+// The path is a JSON selector (".server.port"), in ini files it is the key of a
+// section (".server.port" -> [server] port, ".port" -> global port).
+template<typename S, typename T>
+struct ConfigField {
+    T S::* member;
+    string path;
+    optional<T> defval = nullopt; // none: the field is required
+    string argname = "";          // command line name, overrides the files
+    bool (*validator)(const T&) = nullptr;
+    string hint = "";
+
+    ConfigField arg(const string& name) const {
+        ConfigField field = *this;
+        field.argname = name;
+        return field;
+    }
+
+    ConfigField check(bool (*validator)(const T&), const string& hint) const {
+        ConfigField field = *this;
+        field.validator = validator;
+        field.hint = hint;
+        return field;
+    }
+};
+
+// The ini section and key are cut from the path, so it has to be a selector
+inline const string& config_path(const string& path) {
+    if (path.size() < 2 || path[0] != '.')
+        throw ERROR("Config field path has to start with '.': '" + path + "'");
+    return path;
+}
+
+// Required field
+template<typename S, typename T>
+ConfigField<S, T> config_field(T S::* member, const string& path) {
+    return { member, config_path(path) };
+}
+
+// Field with a default value
+template<typename S, typename T, typename D>
+ConfigField<S, T> config_field(T S::* member, const string& path, D defval) {
+    return { member, config_path(path), T(move(defval)) };
+}
+
+// Where a config is bound from, any of them can be missing.
+// Precedence: args, then ini, then json.
+struct ConfigSources {
+    const JSON* json = nullptr;
+    const IniData* ini = nullptr;
+    const Arguments* args = nullptr;
+};
+
+// Typed config declared once:
+//   struct ServerConfig { string host; int port; };
+//   const auto server_schema = config_schema<ServerConfig>(
+//       config_field(&ServerConfig::host, ".server.host", "localhost"),
+//       config_field(&ServerConfig::port, ".server.port").arg("port")
+//           .check([](const int& p) { return p > 0 && p < 65536; }, "1..65535")
+//   );
+//   ServerConfig conf = server_schema.bind(json);
+// The fields are read in one pass into a plain struct, so later accesses are
+// member reads. Every missing, mistyped or invalid field is reported in a
+// single error.
+template<typename S, typename... Fields>
+class ConfigSchema {
+public:
+    ConfigSchema(Fields... fields): fields(move(fields)...) {}
+
+    S bind(const ConfigSources& sources) const {
+        S config;
+        vector<string> errors;
+        apply([&](const auto&... field) {
+            (bind_field(config, field, sources, errors), ...);
+        }, fields);
+        if (!errors.empty())
+            throw ERROR("Invalid configuration:\n" + implode("\n", errors));
+        return config;
+    }
+
+    S bind(const JSON& json) const {
+        return bind(ConfigSources{ &json, nullptr, nullptr });
+    }
+
+    S bind(const IniData& ini) const {
+        return bind(ConfigSources{ nullptr, &ini, nullptr });
+    }
+
+    S bind(const Arguments& args) const {
+        return bind(ConfigSources{ nullptr, nullptr, &args });
+    }
+
+private:
+
+    // Ini files and arguments hold scalars only, containers come from JSON
+    template<typename T>
+    static constexpr bool is_scalar_v = is_arithmetic_v<T> || is_same_v<T, string>;
+
+    template<typename T>
+    static void bind_field(S& config, const ConfigField<S, T>& field, const ConfigSources& sources, vector<string>& errors) {
+        try {
+            optional<T> value = read(field, sources);
+            if (!value) value = field.defval;
+            if (!value) {
+                errors.push_back(field.path + ": missing");
+                return;
+            }
+            if (field.validator && !field.validator(*value)) {
+                errors.push_back(field.path + ": invalid value" + (field.hint.empty() ? "" : ", expected " + field.hint));
+                return;
+            }
+            config.*field.member = move(*value);
+        } catch (const exception& e) {
+            errors.push_back(field.path + ": " + e.what());
+        }
+    }
+
+    template<typename T>
+    static optional<T> read(const ConfigField<S, T>& field, const ConfigSources& sources) {
+        if constexpr (is_scalar_v<T>) {
+            if (sources.args && !field.argname.empty() && sources.args->has(field.argname))
+                return sources.args->template get<T>(field.argname);
+            if (sources.ini) {
+                size_t dot = field.path.find('.', 1);
+                string section = dot == string::npos ? "" : field.path.substr(1, dot - 1);
+                string key = field.path.substr(dot == string::npos ? 1 : dot + 1);
+                if (sources.ini->has(key, section)) return sources.ini->template get<T>(key, section);
+            }
+        }
+        if (sources.json && sources.json->has(field.path))
+            return sources.json->template get<T>(field.path);
+        return nullopt;
+    }
+
+    tuple<Fields...> fields;
+};
+
+template<typename S, typename... Fields>
+ConfigSchema<S, Fields...> config_schema(Fields... fields) {
+    return ConfigSchema<S, Fields...>(move(fields)...);
+}
+
+// Hot reloadable config: readers take a snapshot with get() and keep using it,
+// reload() binds a new instance and swaps it in atomically. When binding fails
+// the error is thrown and the running config stays in place.
+template<typename S>
+class ConfigLive {
+public:
+    ConfigLive(S config): current(make_shared<const S>(move(config))) {}
+
+    shared_ptr<const S> get() const {
+        return current.load();
+    }
+
+    template<typename Schema, typename Source>
+    void reload(const Schema& schema, const Source& source) {
+        current.store(make_shared<const S>(schema.bind(source)));
+    }
+
+private:
+    atomic<shared_ptr<const S>> current;
+};
@@ -8,7 +8,7 @@ using namespace std;
 class ConsoleLogger: public Logger {
 public:
     ConsoleLogger(): Logger() {}
-    virtual ~ConsoleLogger() {}
+    virtual ~ConsoleLogger() { shutdown(); }
 protected:
     void write(const string& output) override {
         cout << output << endl;
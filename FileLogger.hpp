@@ -2,19 +2,53 @@
 
 #include "ERROR.hpp"
 #include "Logger.hpp"
+#include "EWHAT.hpp"
 #include <fstream>
+#include <filesystem>
+#include <thread>
+#include <queue>
+#include <condition_variable>
+#include <algorithm>
+#include <cstdio>
+#include <cctype>
+#include <zlib.h>
 
 using namespace std;
 
+namespace fs = filesystem;
+
 class FileLogger: public Logger {
 public:
-    FileLogger(const string& filename) : filename(filename) {
-        file.open(filename, ios::app);
-        if (!file.is_open())
-            throw ERROR("Unable to open log file: " + filename);
+    // rotate_size: rotate when the current segment reaches this many bytes (0 = never)
+    // rotate_interval: rotate when the current segment is older than this (0 = never)
+    // retention: how many rotated segments are kept, oldest are removed (0 = keep all)
+    // compress: gzip rotated segments on the background thread (zlib, link with -lz)
+    FileLogger(
+        const string& filename,
+        size_t rotate_size = 0,
+        time_ms rotate_interval = 0,
+        size_t retention = 0,
+        bool compress = false
+    ):
+        filename(filename),
+        rotate_size(rotate_size),
+        rotate_interval(rotate_interval),
+        retention(retention),
+        compress(compress)
+    {
+        open();
+        if (retention || compress)
+            worker = thread([this]() { work(); });
     }
 
     ~FileLogger() {
+        shutdown();
+        {
+            lock_guard<mutex> lock(worker_mtx);
+            stopping = true;
+        }
+        worker_cv.notify_all();
+        if (worker.joinable()) worker.join();
         if (file.is_open()) file.close();
     }
 
@@ -22,10 +56,160 @@ public:
         if (file.is_open()) {
             file << output << endl;
             file.flush();
+            written += output.size() + 1;
+            if (
+                (rotate_size && written >= rotate_size) ||
+                (rotate_interval && get_time_ms() >= rotate_at)
+            ) rotate();
         }
     }
 
+    // Blocks until every rotated segment handed to the background thread is processed
+    void wait() {
+        unique_lock<mutex> lock(worker_mtx);
+        worker_cv.wait(lock, [this]() { return segments.empty() && !busy; });
+    }
+
 private:
+
+    void open() {
+        file.open(filename, ios::app);
+        if (!file.is_open())
+            throw ERROR("Unable to open log file: " + filename);
+        // the only stat call, hot path counts the bytes instead
+        error_code ec;
+        written = fs::exists(filename, ec) ? fs::file_size(filename, ec) : 0;
+        rotate_at = get_time_ms() + rotate_interval;
+    }
+
+    // Called under Logger::mtx, so only a rename and a reopen happen here,
+    // compression and retention run on the worker thread
+    void rotate() {
+        file.close();
+        string segment = filename + "." + ms_to_datetime(get_time_ms(), "%Y%m%d-%H%M%S");
+        // within the same millisecond the sequence keeps growing, even when
+        // retention has already removed the earlier names
+        int seq = segment == last_segment ? last_seq + 1 : 0;
+        string unique;
+        for (;; seq++) {
+            string num = to_string(seq);
+            unique = seq ? segment + "-" + string(num.size() < 4 ? 4 - num.size() : 0, '0') + num : segment; // padded, so names sort by age
+            if (!fs::exists(unique) && !fs::exists(unique + ".gz")) break;
+        }
+        last_segment = segment;
+        last_seq = seq;
+        if (::rename(filename.c_str(), unique.c_str()) != 0)
+            unique.clear(); // keep on writing into the same file
+        open();
+        if (unique.empty() || !worker.joinable()) return;
+        {
+            lock_guard<mutex> lock(worker_mtx);
+            segments.push(unique);
+        }
+        worker_cv.notify_all();
+    }
+
+    void work() {
+        while (true) {
+            string segment;
+            {
+                unique_lock<mutex> lock(worker_mtx);
+                worker_cv.wait(lock, [this]() { return stopping || !segments.empty(); });
+                if (segments.empty()) return;
+                segment = segments.front();
+                segments.pop();
+                busy = true;
+            }
+            try {
+                if (compress) gzip(segment);
+                if (retention) prune();
+            } catch (exception& e) {
+                cerr << "Log rotation failed: " << segment << EWHAT << endl;
+            }
+            {
+                lock_guard<mutex> lock(worker_mtx);
+                busy = false;
+            }
+            worker_cv.notify_all();
+        }
+    }
+
+    // Writes <segment>.gz next to the segment and removes the segment, the
+    // .gz appears only when it is complete
+    static void gzip(const string& segment) {
+        ifstream in(segment, ios::binary);
+        if (!in.is_open())
+            throw ERROR("Unable to open log segment: " + segment);
+        string tmp = segment + ".gz.tmp";
+        gzFile out = gzopen(tmp.c_str(), "wb");
+        if (!out)
+            throw ERROR("Unable to create compressed log segment: " + tmp);
+        char buffer[65536];
+        bool ok = true;
+        while (ok && in.read(buffer, sizeof(buffer)).gcount() > 0)
+            ok = gzwrite(out, buffer, (unsigned)in.gcount()) == (int)in.gcount();
+        ok = gzclose(out) == Z_OK && ok && !in.bad();
+        if (!ok || ::rename(tmp.c_str(), (segment + ".gz").c_str()) != 0) {
+            ::remove(tmp.c_str());
+            throw ERROR("Unable to compress log segment: " + segment);
+        }
+        ::remove(segment.c_str());
+    }
+
+    // Only the names rotate() creates: <prefix>YYYYmmdd-HHMMSS.mmm[-NNNN][.gz]
+    static bool is_segment(const string& name, const string& prefix) {
+        if (name.compare(0, prefix.size(), prefix) != 0) return false;
+        string rest = name.substr(prefix.size());
+        if (rest.size() > 3 && rest.compare(rest.size() - 3, 3, ".gz") == 0)
+            rest.resize(rest.size() - 3);
+        const string stamp = "dddddddd-dddddd.ddd";
+        if (rest.size() < stamp.size()) return false;
+        for (size_t i = 0; i < stamp.size(); i++)
+            if (stamp[i] == 'd' ? !isdigit((unsigned char)rest[i]) : rest[i] != stamp[i]) return false;
+        if (rest.size() == stamp.size()) return true;
+        if (rest[stamp.size()] != '-' || rest.size() < stamp.size() + 5) return false;
+        for (size_t i = stamp.size() + 1; i < rest.size(); i++)
+            if (!isdigit((unsigned char)rest[i])) return false;
+        return true;
+    }
+
+    // Removes the oldest rotated segments above the retention count
+    void prune() {
+        fs::path path(filename);
+        fs::path dir = path.parent_path().empty() ? fs::path(".") : path.parent_path();
+        string prefix = path.filename().string() + ".";
+        vector<string> rotated;
+        for (const fs::directory_entry& entry: fs::directory_iterator(dir)) {
+            string name = entry.path().filename().string();
+            if (entry.is_regular_file() && is_segment(name, prefix))
+                rotated.push_back(entry.path().string());
+        }
+        if (rotated.size() <= retention) return;
+        // segment names start with the rotation time, so the name order is the age order
+        auto key = [](const string& name) {
+            return name.size() > 3 && name.compare(name.size() - 3, 3, ".gz") == 0 ? name.substr(0, name.size() - 3) : name;
+        };
+        sort(rotated.begin(), rotated.end(), [&key](const string& a, const string& b) { return key(a) < key(b); });
+        for (size_t i = 0; i < rotated.size() - retention; i++)
+            fs::remove(rotated[i]);
+    }
+
     ofstream file;
     string filename;
+    size_t rotate_size;
+    time_ms rotate_interval;
+    size_t retention;
+    bool compress;
+
+    size_t written = 0;
+    time_ms rotate_at = 0;
+    string last_segment;
+    int last_seq = 0;
+
+    thread worker;
+    mutex worker_mtx;
+    condition_variable worker_cv;
+    queue<string> segments;
+    bool stopping = false;
+    bool busy = false;
 };
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include "EMPTY_OR.hpp"
 #include "ERROR.hpp"
 #include "parse.hpp"
+#include "str_append_number.hpp"
 
 using namespace std;
 
@@ -93,5 +94,5 @@ private:
     inline string as_string(const char* str) { return str; }
 
     template<typename T>
-    inline string as_string(T str) { return std::to_string(str); }
+    inline string as_string(T str) { return str_number(str); }
 };
@@ -16,116 +16,140 @@
 #include "str_diffs_show.hpp"
 #include "str_contains.hpp"
 #include "ERROR.hpp"
+#include "json_cbor.hpp"
+#include "json_patch.hpp"
 #include <string>
 #include <vector>
 #include <stack>
 #include <regex>
+#include <list>
+#include <memory>
+#include <string_view>
+#include <cstring>
+#include <cstdio>
+#include <unordered_map>
+#include <atomic>
 
 using namespace std;
 using namespace nlohmann;
 
 string json_last_error = "";
 
-// Function to remove single-line and multi-line comments
-string json_remove_comments(const string& json) {
-    string result;
-    bool inString = false;
-    bool escapeNext = false;
-    bool inSingleLineComment = false;
-    bool inMultiLineComment = false;
+// Source of JSON::version() values, unique across all documents
+atomic<size_t> json_versions = 0;
+
+size_t json_version_next() {
+    return json_versions.fetch_add(1, memory_order_relaxed) + 1;
+}
 
-    for (size_t i = 0; i < json.size(); ++i) {
-        char ch = json[i];
+// Characters json_sanitize() has to look at, everything else is copied in spans
+struct JSONSanitizeStops {
+    bool code[256] = {}; // outside strings
+    bool text[256] = {}; // inside strings
+    constexpr JSONSanitizeStops() {
+        code[(unsigned char)'"'] = code[(unsigned char)'/'] = code[(unsigned char)','] = true;
+        text[(unsigned char)'"'] = text[(unsigned char)'\\'] = true;
+    }
+};
 
-        if (inString && ch == '\\' && !escapeNext) {
-            escapeNext = true;
-            result += ch;
+// Fused comment / trailing comma removal, works in place over data[0, size)
+// and returns the new size. The output never grows, so the write position
+// trails the read position and no second buffer is needed.
+// A comma is written out, and taken back when the next character that is
+// neither whitespace nor comment turns out to be '}' or ']'.
+size_t json_sanitize(char* data, size_t size, bool trailing_commas) {
+    static constexpr JSONSanitizeStops stops;
+    size_t w = 0, r = 0;
+    size_t comma = string::npos; // write position of a comma that may still be trailing
+    bool inString = false;
+    auto span = [&](const bool* stop) {
+        size_t from = r;
+        while (r < size && !stop[(unsigned char)data[r]]) r++;
+        if (w != from) memmove(data + w, data + from, r - from);
+        w += r - from;
+    };
+    while (r < size) {
+        if (inString) {
+            span(stops.text);
+            if (r >= size) break;
+            char ch = data[r++];
+            data[w++] = ch;
+            if (ch == '"') inString = false;
+            else if (r < size) data[w++] = data[r++]; // escaped character
             continue;
         }
-
-        if (ch == '"' && !escapeNext && !inSingleLineComment && !inMultiLineComment) {
-            inString = !inString;
+        if (comma == string::npos) {
+            span(stops.code);
+            if (r >= size) break;
         }
-
-        if (!inString && !inMultiLineComment && ch == '/' && i + 1 < json.size() && json[i + 1] == '/') {
-            inSingleLineComment = true;
-            i++;
+        char ch = data[r];
+        if (ch == '/' && r + 1 < size && data[r + 1] == '/') {
+            const char* nl = (const char*)memchr(data + r + 2, '\n', size - r - 2);
+            r = nl ? nl - data : size; // the newline itself is kept
             continue;
         }
-
-        if (!inString && !inSingleLineComment && ch == '/' && i + 1 < json.size() && json[i + 1] == '*') {
-            inMultiLineComment = true;
-            i++;
+        if (ch == '/' && r + 1 < size && data[r + 1] == '*') {
+            size_t end = string_view(data, size).find("*/", r + 2);
+            r = end == string_view::npos ? size : end + 2;
             continue;
         }
-
-        if (inSingleLineComment && ch == '\n') {
-            inSingleLineComment = false;
-        }
-
-        if (inMultiLineComment && ch == '*' && i + 1 < json.size() && json[i + 1] == '/') {
-            inMultiLineComment = false;
-            i++;
+        r++;
+        if (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r') {
+            data[w++] = ch;
             continue;
         }
-
-        if (!inSingleLineComment && !inMultiLineComment) {
-            result += ch;
+        if (comma != string::npos) {
+            if (ch == '}' || ch == ']') {
+                memmove(data + comma, data + comma + 1, w - comma - 1);
+                w--;
+            }
+            comma = string::npos;
         }
-
-        escapeNext = false;
+        if (ch == '"') inString = true;
+        else if (ch == ',' && trailing_commas) comma = w;
+        data[w++] = ch;
     }
+    return w;
+}
 
+// Function to remove single-line and multi-line comments
+string json_remove_comments(const string& json) {
+    string result = json;
+    result.resize(json_sanitize(result.data(), result.size(), false));
     return result;
 }
 
-// Function to fix JSON by removing trailing commas
-string json_fix(string json) {
-    json = json_remove_comments(json);
-    string result;
-    bool inString = false;
-    bool escapeNext = false;
-    stack<char> scopeStack;
-
-    for (size_t i = 0; i < json.size(); ++i) {
-        char ch = json[i];
-
-        if (ch == '"' && !escapeNext) {
-            inString = !inString;
-        }
-
-        if (ch == '\\' && !escapeNext) {
-            escapeNext = true;
-        } else {
-            escapeNext = false;
-        }
-
-        if (!inString) {
-            if (ch == '{' || ch == '[') {
-                scopeStack.push(ch);
-            } else if (ch == '}' || ch == ']') {
-                if (!scopeStack.empty()) {
-                    scopeStack.pop();
-                }
-            }
-        }
-
-        if (!inString && ch == ',') {
-            size_t j = i + 1;
-            while (j < json.size() && (json[j] == ' ' || json[j] == '\t' || json[j] == '\n' || json[j] == '\r')) {
-                ++j;
-            }
-            if (j < json.size() && (json[j] == '}' || json[j] == ']')) {
-                continue;
-            }
-        }
-
-        result += ch;
+// True when json has no "//", "/*" or a comma followed (after whitespace)
+// by '}' or ']', so json_fix() has nothing to do. Strings are not looked
+// into, a "//" in an URL only means the full pass runs.
+bool json_fix_needed(const string& json) {
+    const char* data = json.data();
+    const char* end = data + json.size();
+    for (const char* p = data; (p = (const char*)memchr(p, '/', end - p)); p++)
+        if (p + 1 < end && (p[1] == '/' || p[1] == '*')) return true;
+    for (const char* p = data; (p = (const char*)memchr(p, ',', end - p)); p++) {
+        const char* q = p + 1;
+        while (q < end && (*q == ' ' || *q == '\t' || *q == '\n' || *q == '\r')) q++;
+        if (q < end && (*q == '}' || *q == ']')) return true;
     }
+    return false;
+}
 
-    return result;
+// Function to fix JSON by removing comments and trailing commas
+string json_fix(string json) {
+    if (!json_fix_needed(json)) return json;
+    json.resize(json_sanitize(json.data(), json.size(), true));
+    return json;
 }
 
+// Default text parser of the JSON class: json_fix(), then nlohmann::json::parse
+nlohmann::json json_parse_default(const string& jstring) {
+    return nlohmann::json::parse(json_fix(jstring));
+}
+
+// Parser used by JSON(string), can be swapped (see json_parse_fast.hpp)
+nlohmann::json (*json_parse)(const string&) = json_parse_default;
+
 // Enum to represent JSON value types
 enum json_type {
     JSON_TYPE_UNDEFINED,
@@ -141,41 +165,112 @@ enum json_type {
 // Global variable to store the last JSON parsing error
 extern string json_last_error;
 
-// Function to convert jq-style or JavaScript-style selector to json_pointer
-nlohmann::json::json_pointer _json_selector(string jselector) {
-    if (jselector.empty()) return nlohmann::json::json_pointer("/");
-    if (jselector[0] != '.') jselector = "." + jselector;
-
-    vector<string> splits = explode(".", jselector);
-
-    for (size_t i = 1; i < splits.size(); i++) {
-        if (splits[i].empty())
-            throw ERROR("Invalid json selector: " + jselector);
-
-        regex valid_brackets("\\[\\s*(\\d+)\\s*\\]$");
-        regex invalid_brackets("\\[[^\\]]+\\]$");
-        smatch match;
+constexpr bool json_selector_is_space(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\v' || ch == '\f' || ch == '\r';
+}
 
-        if (regex_search(splits[i], match, valid_brackets)) {
-            splits[i] = regex_replace(splits[i], valid_brackets, "/$1");
-            continue;
+// Converts one selector part ("key", "key[3]") to json_pointer text ("key", "key/3")
+constexpr bool json_selector_part_to_pointer(string_view part, string* pointer) {
+    size_t last = part.size() - 1;
+    size_t open = part.rfind('[');
+    if (part[last] == ']' && open != string_view::npos) {
+        size_t from = open + 1, to = last;
+        while (from < to && json_selector_is_space(part[from])) from++;
+        while (to > from && json_selector_is_space(part[to - 1])) to--;
+        bool digits = from < to;
+        for (size_t i = from; i < to && digits; i++)
+            digits = part[i] >= '0' && part[i] <= '9';
+        if (digits) { // key[N] -> key/N
+            if (pointer) {
+                pointer->append(part.substr(0, open));
+                pointer->append("/");
+                pointer->append(part.substr(from, to - from));
+            }
+            return true;
         }
+        size_t close = last ? part.rfind(']', last - 1) : string_view::npos;
+        size_t content = last >= 2 ? part.rfind('[', last - 2) : string_view::npos;
+        if (content != string_view::npos && (close == string_view::npos || content > close))
+            return false; // [not-numeric]
+    }
+    if (pointer) pointer->append(part);
+    return true;
+}
 
-        if (regex_search(splits[i], match, invalid_brackets)) {
-            throw ERROR("Invalid json selector: " + jselector);
-        }
+// Converts a jq-style or JavaScript-style selector (.a.b[3].c) to json_pointer text (/a/b/3/c),
+// returns false if the selector is invalid, constexpr so selector literals can be checked at compile time
+constexpr bool json_selector_to_pointer(string_view jselector, string* pointer = nullptr) {
+    if (pointer) pointer->clear();
+    if (jselector.empty()) {
+        if (pointer) pointer->append("/");
+        return true;
     }
 
-    int open_brackets = 0, close_brackets = 0;
-    for (char ch : jselector) {
-        if (ch == '[') open_brackets++;
-        if (ch == ']') close_brackets++;
+    int brackets = 0;
+    for (char ch: jselector) {
+        if (ch == '[') brackets++;
+        if (ch == ']') brackets--;
     }
-    if (open_brackets != close_brackets) {
-        throw ERROR("Invalid json selector: " + jselector);
+    if (brackets) return false;
+
+    size_t start = jselector[0] == '.' ? 1 : 0;
+    while (true) {
+        size_t end = jselector.find('.', start);
+        string_view part = jselector.substr(start, end == string_view::npos ? string_view::npos : end - start);
+        if (part.empty()) return false;
+        if (pointer) pointer->append("/");
+        if (!json_selector_part_to_pointer(part, pointer)) return false;
+        if (end == string_view::npos) break;
+        start = end + 1;
     }
 
-    return nlohmann::json::json_pointer(implode("/", splits));
+    if (!pointer) // json_pointer escapes, checked by json_pointer itself at runtime
+        for (size_t i = 0; i < jselector.size(); i++)
+            if (jselector[i] == '~' && (i + 1 == jselector.size() || (jselector[i + 1] != '0' && jselector[i + 1] != '1')))
+                return false;
+
+    return true;
+}
+
+#ifndef JSON_SELECTOR_CACHE_SIZE
+#define JSON_SELECTOR_CACHE_SIZE 4096
+#endif
+
+// Compiled json_pointer of a selector from a per-thread cache, so a selector is parsed
+// only the first time it is seen. The reference is valid until the next call on the thread.
+const nlohmann::json::json_pointer& json_selector(const string& jselector) {
+    static thread_local unordered_map<string, nlohmann::json::json_pointer> cache;
+    auto it = cache.find(jselector);
+    if (it != cache.end()) return it->second;
+
+    string pointer;
+    if (!json_selector_to_pointer(jselector, &pointer))
+        throw ERROR("Invalid json selector: " + (jselector.empty() || jselector[0] == '.' ? jselector : "." + jselector));
+
+    nlohmann::json::json_pointer compiled(pointer);
+    if (cache.size() >= JSON_SELECTOR_CACHE_SIZE) cache.clear();
+    return cache.emplace(jselector, move(compiled)).first->second;
+}
+
+// Function to convert jq-style or JavaScript-style selector to json_pointer
+nlohmann::json::json_pointer _json_selector(string jselector) {
+    return json_selector(jselector);
+}
+
+// Selector literal validated at compile time: JSONSelector(".a.b[3].c") or ".a.b[3].c"_jsel
+struct JSONSelector {
+    consteval JSONSelector(const char* jselector): jselector(jselector) {
+        if (!json_selector_to_pointer(jselector))
+            throw "Invalid json selector";
+    }
+
+    operator string() const { return jselector; }
+
+    const char* jselector;
+};
+
+consteval JSONSelector operator""_jsel(const char* jselector, size_t) {
+    return JSONSelector(jselector);
 }
 
 // Check if a JSON string is valid
@@ -197,28 +292,150 @@ string get_json_error(string jstring) {
     return json_last_error;
 }
 
-// Get the type of a JSON value at a given selector
-json_type get_json_value_type(string jstring, string jselector) {
-    try {
-        auto json = nlohmann::json::parse(jstring);
-        auto ptr = _json_selector(jselector);
+// Get the type of a JSON value
+json_type json_value_type(const nlohmann::json& value) {
+    if (value.is_null()) return JSON_TYPE_NULL;
+    if (value.is_string()) return JSON_TYPE_STRING;
+    if (value.is_boolean()) return JSON_TYPE_BOOLEAN;
+    if (value.is_number_integer()) return JSON_TYPE_INTEGER;
+    if (value.is_number_float()) return JSON_TYPE_REAL;
+    if (value.is_array()) return JSON_TYPE_ARRAY;
+    if (value.is_object()) return JSON_TYPE_OBJECT;
+    return JSON_TYPE_UNDEFINED;
+}
 
-        if (!json.contains(ptr))
-            return JSON_TYPE_UNDEFINED;
+// JSON text parsed once, with typed accessors by selector,
+// reading many fields does not parse the text again
+class JSONDocument {
+public:
+    JSONDocument(const string& jstring) {
+        try {
+            j = nlohmann::json::parse(jstring);
+            valid = true;
+        } catch (const nlohmann::json::exception& e) { // parse errors and out of range numbers
+            error = e.what();
+        }
+    }
+
+    bool isValid(string* error = nullptr) const {
+        if (error) *error = this->error;
+        return valid;
+    }
 
-        const auto& value = json.at(ptr);
-        if (value.is_null()) return JSON_TYPE_NULL;
-        if (value.is_string()) return JSON_TYPE_STRING;
-        if (value.is_boolean()) return JSON_TYPE_BOOLEAN;
-        if (value.is_number_integer()) return JSON_TYPE_INTEGER;
-        if (value.is_number_float()) return JSON_TYPE_REAL;
-        if (value.is_array()) return JSON_TYPE_ARRAY;
-        if (value.is_object()) return JSON_TYPE_OBJECT;
+    const nlohmann::json& get_json() const { return j; }
 
-        return JSON_TYPE_UNDEFINED;
-    } catch (...) {
-        return JSON_TYPE_UNDEFINED;
+    json_type type(const string& jselector) const {
+        const nlohmann::json* value = find(jselector);
+        return value ? json_value_type(*value) : JSON_TYPE_UNDEFINED;
     }
+
+    bool has(const string& jselector) const {
+        return find(jselector);
+    }
+
+    string getString(const string& jselector) const {
+        try {
+            return at(jselector, JSON_TYPE_STRING, "string").get<string>();
+        } catch (const nlohmann::json::exception& e) {
+            throw ERROR("Error retrieving string: " + string(e.what()));
+        }
+    }
+
+    int getInt(const string& jselector) const {
+        try {
+            return at(jselector, JSON_TYPE_INTEGER, "integer").get<int>();
+        } catch (const nlohmann::json::exception& e) {
+            throw ERROR("Error retrieving integer: " + string(e.what()));
+        }
+    }
+
+    double getDouble(const string& jselector) const {
+        try {
+            return at(jselector, JSON_TYPE_REAL, "real").get<double>();
+        } catch (const nlohmann::json::exception& e) {
+            throw ERROR("Error retrieving double: " + string(e.what()));
+        }
+    }
+
+    bool getBool(const string& jselector) const {
+        try {
+            return at(jselector, JSON_TYPE_BOOLEAN, "boolean").get<bool>();
+        } catch (const nlohmann::json::exception& e) {
+            throw ERROR("Error retrieving boolean: " + string(e.what()));
+        }
+    }
+
+    string getArray(const string& jselector) const {
+        try {
+            return at(jselector, JSON_TYPE_ARRAY, "array").dump();
+        } catch (const nlohmann::json::exception& e) {
+            throw ERROR("Error retrieving array: " + string(e.what()));
+        }
+    }
+
+    string getObject(const string& jselector) const {
+        try {
+            return at(jselector, JSON_TYPE_OBJECT, "object").dump();
+        } catch (const nlohmann::json::exception& e) {
+            throw ERROR("Error retrieving object: " + string(e.what()));
+        }
+    }
+
+private:
+
+    const nlohmann::json* find(const string& jselector) const {
+        if (!valid) return nullptr;
+        try {
+            const nlohmann::json::json_pointer& ptr = json_selector(jselector);
+            return j.contains(ptr) ? &j.at(ptr) : nullptr;
+        } catch (...) {
+            return nullptr;
+        }
+    }
+
+    const nlohmann::json& at(const string& jselector, json_type expected, const string& name) const {
+        const nlohmann::json* value = find(jselector);
+        if (!value || json_value_type(*value) != expected)
+            throw ERROR("Expected " + name + " type at " + jselector);
+        return *value;
+    }
+
+    nlohmann::json j;
+    bool valid = false;
+    string error;
+};
+
+#ifndef JSON_DOCUMENT_CACHE_SIZE
+#define JSON_DOCUMENT_CACHE_SIZE 16
+#endif
+
+// Parsed document of a JSON text, from a per-thread LRU of the last
+// JSON_DOCUMENT_CACHE_SIZE texts keyed by content hash
+shared_ptr<const JSONDocument> json_document(const string& jstring) {
+    struct Entry {
+        size_t hash;
+        string jstring;
+        shared_ptr<const JSONDocument> document;
+    };
+    static thread_local list<Entry> cache;
+
+    size_t hash = std::hash<string>()(jstring);
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+        if (it->hash == hash && it->jstring == jstring) {
+            cache.splice(cache.begin(), cache, it);
+            return it->document;
+        }
+    }
+
+    shared_ptr<const JSONDocument> document = make_shared<const JSONDocument>(jstring);
+    cache.push_front({ hash, jstring, document });
+    if (cache.size() > JSON_DOCUMENT_CACHE_SIZE) cache.pop_back();
+    return document;
+}
+
+// Get the type of a JSON value at a given selector
+json_type get_json_value_type(string jstring, string jselector) {
+    return json_document(jstring)->type(jselector);
 }
 
 // Convert a json_type enum to its string representation
@@ -238,117 +455,209 @@ string json_type_to_string(json_type type) {
 }
 
 // Retrieve specific JSON value types
+// (adapters over json_document(), repeated reads of the same text are not parsed again)
 string json_get_string(string jstring, string jselector) {
-    if (get_json_value_type(jstring, jselector) != JSON_TYPE_STRING)
-        throw ERROR("Expected string type at " + jselector);
-    try {
-        auto json = nlohmann::json::parse(jstring);
-        return json.at(_json_selector(jselector)).get<string>();
-    } catch (const nlohmann::json::exception& e) {
-        throw ERROR("Error retrieving string: " + string(e.what()));
-    }
+    return json_document(jstring)->getString(jselector);
 }
 
 int json_get_int(string jstring, string jselector) {
-    if (get_json_value_type(jstring, jselector) != JSON_TYPE_INTEGER)
-        throw ERROR("Expected integer type at " + jselector);
-    try {
-        auto json = nlohmann::json::parse(jstring);
-        return json.at(_json_selector(jselector)).get<int>();
-    } catch (const nlohmann::json::exception& e) {
-        throw ERROR("Error retrieving integer: " + string(e.what()));
-    }
+    return json_document(jstring)->getInt(jselector);
 }
 
 double json_get_double(string jstring, string jselector) {
-    if (get_json_value_type(jstring, jselector) != JSON_TYPE_REAL)
-        throw ERROR("Expected real type at " + jselector);
-    try {
-        auto json = nlohmann::json::parse(jstring);
-        return json.at(_json_selector(jselector)).get<double>();
-    } catch (const nlohmann::json::exception& e) {
-        throw ERROR("Error retrieving double: " + string(e.what()));
-    }
+    return json_document(jstring)->getDouble(jselector);
 }
 
 bool json_get_bool(string jstring, string jselector) {
-    if (get_json_value_type(jstring, jselector) != JSON_TYPE_BOOLEAN)
-        throw ERROR("Expected boolean type at " + jselector);
-    try {
-        auto json = nlohmann::json::parse(jstring);
-        return json.at(_json_selector(jselector)).get<bool>();
-    } catch (const nlohmann::json::exception& e) {
-        throw ERROR("Error retrieving boolean: " + string(e.what()));
-    }
+    return json_document(jstring)->getBool(jselector);
 }
 
 string json_get_array(string jstring, string jselector) {
-    if (get_json_value_type(jstring, jselector) != JSON_TYPE_ARRAY)
-        throw ERROR("Expected array type at " + jselector);
-    try {
-        auto json = nlohmann::json::parse(jstring);
-        return json.at(_json_selector(jselector)).dump();
-    } catch (const nlohmann::json::exception& e) {
-        throw ERROR("Error retrieving array: " + string(e.what()));
-    }
+    return json_document(jstring)->getArray(jselector);
 }
 
 string json_get_object(string jstring, string jselector) {
-    if (get_json_value_type(jstring, jselector) != JSON_TYPE_OBJECT)
-        throw ERROR("Expected object type at " + jselector);
-    try {
-        auto json = nlohmann::json::parse(jstring);
-        return json.at(_json_selector(jselector)).dump();
-    } catch (const nlohmann::json::exception& e) {
-        throw ERROR("Error retrieving object: " + string(e.what()));
-    }
+    return json_document(jstring)->getObject(jselector);
 }
 
+class JSON;
+
+// Non-owning read access to a JSON (sub)document, nothing is copied.
+// Valid while the document it points into is alive and that part is not replaced.
+class JSONView {
+public:
+    JSONView(const nlohmann::json& j): j(&j) {}
+
+    const nlohmann::json& get_json_cref() const {
+        return *j;
+    }
+
+    string dump(int indent = -1, char indent_char = ' ') const {
+        try {
+            return j->dump(indent, indent_char);
+        } catch (const exception& e) {
+            throw ERROR("JSON dump error: " + string(e.what()));
+        }
+    }
+
+    bool has(const string& jselector) const {
+        try {
+            const nlohmann::json::json_pointer& ptr = json_selector(jselector);
+            return j->contains(ptr);
+        } catch (...) {
+            return false;
+        }
+    }
+
+    bool isNull(const string& jselector) const {
+        const nlohmann::json* at = find(jselector);
+        return at && at->is_null();
+    }
+
+    bool isArray(const string& jselector) const {
+        const nlohmann::json* at = find(jselector);
+        return at && at->is_array();
+    }
+
+    bool isObject(const string& jselector) const {
+        const nlohmann::json* at = find(jselector);
+        return at && at->is_object();
+    }
+
+    // T = JSONView gives a view of the subtree, T = JSON an owning copy of it
+    template<typename T>
+    T get(const string& jselector) const {
+        try {
+            const nlohmann::json::json_pointer& ptr = json_selector(jselector);
+            if constexpr (is_same_v<T, JSONView>) return JSONView(j->at(ptr));
+            else if constexpr (is_same_v<T, JSON>) return T(j->at(ptr));
+            else return j->at(ptr).get<T>();
+        } catch (const exception& e) {
+            throw ERROR("JSON Error at: " + jselector + ", reason: " + string(e.what()));
+        }
+    }
+
+    // No selector: the viewed node itself
+    JSONView view(const string& jselector = "") const {
+        return jselector.empty() ? *this : get<JSONView>(jselector);
+    }
+
+private:
+    const nlohmann::json* find(const string& jselector) const {
+        try {
+            const nlohmann::json::json_pointer& ptr = json_selector(jselector);
+            return j->contains(ptr) ? &j->at(ptr) : nullptr;
+        } catch (...) {
+            return nullptr;
+        }
+    }
+
+    const nlohmann::json* j;
+};
+
 // JSON class to manage JSON data
 class JSON {
 protected:
     string* _error = nullptr;
     nlohmann::json j;
+    size_t _version = json_version_next();
 
 public:
     JSON(const nlohmann::json& j) : j(j) {}
+    JSON(nlohmann::json&& j) : j(move(j)) {}
     JSON(const char* j) : JSON(string(j)) {}
     JSON(string jstring = "{}") {
         try {
-            j = nlohmann::json::parse(jstring.empty() ? "{}" : json_fix(jstring));
+            j = jstring.empty() ? nlohmann::json::object() : json_parse(jstring);
         } catch (const exception& e) {
             _error = new string(e.what());
         }
     }
 
+    JSON(const JSON& other) : _error(other._error ? new string(*other._error) : nullptr), j(other.j) {}
+
+    JSON(JSON&& other) noexcept : _error(other._error), j(move(other.j)) {
+        other._error = nullptr;
+        other.touch();
+    }
+
+    JSON& operator=(const JSON& other) {
+        if (this != &other) {
+            string* error = other._error ? new string(*other._error) : nullptr;
+            j = other.j;
+            delete _error;
+            _error = error;
+            touch();
+        }
+        return *this;
+    }
+
+    JSON& operator=(JSON&& other) noexcept {
+        if (this != &other) {
+            j = move(other.j);
+            delete _error;
+            _error = other._error;
+            other._error = nullptr;
+            touch();
+            other.touch();
+        }
+        return *this;
+    }
+
     virtual ~JSON() {
         if (_error) { delete _error; _error = nullptr; }
     }
 
+    // Copy of the whole document, use get_json_cref() or view() to read without copying
     nlohmann::json get_json() const {
         return j;
     }
 
+    const nlohmann::json& get_json_cref() const {
+        return j;
+    }
+
+    // Counts as a change (see version()) when it is taken. Writes through a
+    // reference kept for later are not seen, call touch() after them.
+    nlohmann::json& get_json_ref() {
+        touch();
+        return j;
+    }
+
+    // Changes on every set(), assignment, get_json_ref() or touch(), caches
+    // built from this document compare it to know when they went stale
+    size_t version() const {
+        return _version;
+    }
+
+    // Marks the document changed, for writes made through a kept get_json_ref()
+    void touch() {
+        _version = json_version_next();
+    }
+
+    // Subtree of this document without copying, see JSONView
+    JSONView view(const string& jselector = "") const {
+        return JSONView(j).view(jselector);
+    }
+
+    // Binary snapshot instead of dump(), loading skips the text parser
+    void save_cbor(const string& filename) const {
+        json_save_cbor(filename, j);
+    }
+
+    static JSON load_cbor(const string& filename);
+
     bool isValid(string* error = nullptr) {
         if (error) *error = _error ? *_error : "";
         return !_error;
     }
 
     string dump(int indent = -1, char indent_char = ' ') const {
-        try {
-            return j.dump(indent, indent_char);
-        } catch (const exception& e) {
-            throw ERROR("JSON dump error: " + string(e.what()));
-        }
+        return JSONView(j).dump(indent, indent_char);
     }
    
     bool isDefined(string jselector) const {
-        try {
-            nlohmann::json::json_pointer ptr = _json_selector(jselector);
-            return j.contains(ptr);
-        } catch (...) {
-            return false;
-        }
+        return JSONView(j).has(jselector);
     }
 
     bool has(string jselector) const {
@@ -356,63 +665,62 @@ public:
     }
 
     bool isNull(string jselector) {
-        try {
-            nlohmann::json::json_pointer ptr = _json_selector(jselector);
-            return j.at(ptr).is_null();
-        } catch (...) {
-            return false;
-        }
+        return JSONView(j).isNull(jselector);
     }
 
     bool isArray(string jselector) {
-        try {
-            nlohmann::json::json_pointer ptr = _json_selector(jselector);
-            return j.at(ptr).is_array();
-        } catch (...) {
-            return false;
-        }
+        return JSONView(j).isArray(jselector);
     }
 
     bool isObject(string jselector) {
-        try {
-            nlohmann::json::json_pointer ptr = _json_selector(jselector);
-            return j.at(ptr).is_object();
-        } catch (...) {
-            return false;
-        }
+        return JSONView(j).isObject(jselector);
     }
-    
 
     template<typename T>
     T get(string jselector) const {
-        try {
-            json::json_pointer ptr = _json_selector(jselector);  // Convert selector to pointer
-            if constexpr (is_same_v<T, JSON>) return JSON(j.at(ptr));
-            return j.at(ptr).get<T>();
-        } catch (const exception& e) {
-            // DEBUG(j.dump());
-            throw ERROR("JSON Error at: " + jselector + ", reason: " + string(e.what()));
-        }
+        return JSONView(j).get<T>(jselector);
     }
 
     // void set(string value) {
     //     jstring = value;
     // }
 
+    // The value is moved into the document, pass rvalues to avoid copying trees
     template<typename T>
     void set(string jselector, T value) {
         try {
-            // json j = json::parse(jstring);
-            json::json_pointer ptr = _json_selector(jselector);
-            // j[ptr] = value;
-            // jstring = j.dump();
-            j[ptr] = value;
+            const json::json_pointer& ptr = json_selector(jselector);
+            if constexpr (is_same_v<T, JSON>) j[ptr] = move(value.j);
+            else j[ptr] = move(value);
+            touch();
         } catch (const json::exception& e) {
             //DEBUG(j.dump());
             throw ERROR("JSON Error at: " + jselector + ", reason: " + string(e.what()));
         }
     }
 
+    // RFC 6902 patch turning this document into target, see json_diff()
+    nlohmann::json diff(const JSON& target) const {
+        return json_diff(j, target.j);
+    }
+
+    // Applies an RFC 6902 patch in place, only the addressed nodes are touched.
+    // Not atomic: when an operation fails the ones before it stay applied.
+    void patch(const nlohmann::json& ops) {
+        touch();
+        try {
+            j.patch_inplace(ops);
+        } catch (const json::exception& e) {
+            throw ERROR("JSON patch failed: " + string(e.what()));
+        }
+    }
+
+    // Applies an RFC 7386 merge patch in place
+    void merge_patch(const nlohmann::json& changes) {
+        touch();
+        j.merge_patch(changes);
+    }
+
     // Commented-out validation helpers (retained for future use)
     // void need(const string& field) const;
     // void need(const vector<string>& fields) const;
@@ -426,8 +734,14 @@ namespace nlohmann {
         }
         
         static void to_json(json& j, const JSON& jsonObj) {
-            j = jsonObj.get_json();
+            j = jsonObj.get_json_cref();
         }
     };
 }
 
+// Defined after adl_serializer<JSON>, returning a JSON here instantiates it
+JSON JSON::load_cbor(const string& filename) {
+    JSON loaded;
+    loaded.j = json_load_cbor(filename);
+    return loaded;
+}
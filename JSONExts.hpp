@@ -4,9 +4,32 @@
 
 class JSONExts {
 public:
+    JSONExts() {}
 
+    // Copies and moves get a version of their own (see version())
+    JSONExts(const JSONExts& other) : exts(other.exts) {}
+
+    JSONExts(JSONExts&& other) noexcept : exts(move(other.exts)) {
+        other._version = json_version_next();
+    }
+
+    JSONExts& operator=(const JSONExts& other) {
+        exts = other.exts;
+        _version = json_version_next();
+        return *this;
+    }
+
+    JSONExts& operator=(JSONExts&& other) noexcept {
+        exts = move(other.exts);
+        _version = json_version_next();
+        other._version = json_version_next();
+        return *this;
+    }
+
+    // Pass an rvalue (or a temporary) to move the document in instead of copying it
     void extends(JSON ext) {
-        exts.emplace(exts.begin(), ext);
+        exts.emplace(exts.begin(), move(ext));
+        _version = json_version_next();
     }
 
     template<typename T>
@@ -17,6 +40,14 @@ public:
         throw ERROR("No value at '" + jselector + "'");
     }
 
+    // View into the first extension that has the selector, nothing is copied
+    JSONView view(string jselector) const {
+        for (const JSON& ext: exts)
+            if (ext.has(jselector))
+                return ext.view(jselector);
+        throw ERROR("No value at '" + jselector + "'");
+    }
+
     bool has(string jselector) const {
         for (const JSON& ext: exts)
             if (ext.has(jselector))
@@ -27,21 +58,30 @@ public:
     template<typename T>
     void set(string jselector, T value) {
         if (exts.empty()) exts.push_back(JSON("{}"));
-        exts[0].set(jselector, value);
+        exts[0].set(jselector, move(value));
+        _version = json_version_next();
     }
 
     bool empty() const {
         return exts.empty();
     }
 
+    // Changes on every extends(), set() and assignment, like JSON::version()
+    size_t version() const {
+        return _version;
+    }
+
     string dump(const int indent = -1, const char indent_char = ' ') const {
-        vector<string> dumps;
-        for (const JSON& ext: exts)
-            dumps.push_back(ext.dump(indent, indent_char));
-        return "[" + implode(",", dumps) + "]";
+        string dumps = "[";
+        for (size_t i = 0; i < exts.size(); i++) {
+            if (i) dumps += ",";
+            dumps += exts[i].dump(indent, indent_char);
+        }
+        return dumps + "]";
     }
 
 private:
     vector<JSON> exts;
+    size_t _version = json_version_next();
 };
 
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "JSON.hpp"
+#include "json_cbor.hpp"
+#include <unordered_map>
+#include <mutex>
+
+using namespace std;
+
+// Lazily decoded CBOR snapshot (see JSON::save_cbor): the file is memory mapped,
+// a selector is resolved by walking the CBOR headers and skipping the siblings,
+// and only the addressed subtree is decoded (then kept for the next access).
+// Thread safe: the cache is locked, decoding runs outside of the lock.
+class JSONLazy {
+public:
+    JSONLazy(const string& filename):
+        file(filename),
+        reader((const uint8_t*)file.data(), (const uint8_t*)file.data() + file.size(), filename)
+    {
+        if (!file.size()) throw ERROR("Empty CBOR file: " + filename);
+    }
+
+    bool has(const string& jselector) const {
+        try {
+            return locate(pointer(jselector));
+        } catch (...) {
+            return false;
+        }
+    }
+
+    template<typename T>
+    T get(const string& jselector) const {
+        try {
+            const nlohmann::json& node = decode(pointer(jselector));
+            if constexpr (is_same_v<T, JSONView>) return JSONView(node);
+            else if constexpr (is_same_v<T, JSON>) return JSON(node);
+            else return node.get<T>();
+        } catch (const exception& e) {
+            throw ERROR("JSON Error at: " + jselector + ", reason: " + string(e.what()));
+        }
+    }
+
+    // No selector: the whole document
+    JSONView view(const string& jselector = "") const {
+        return get<JSONView>(jselector);
+    }
+
+    // Subtrees decoded so far
+    size_t decoded() const {
+        lock_guard<mutex> lock(cache_mutex);
+        return cache.size();
+    }
+
+private:
+
+    // "" is the whole document here (as a selector it would be the "" key)
+    static string pointer(const string& jselector) {
+        return jselector.empty() ? "" : json_selector(jselector).to_string();
+    }
+
+    // Cached nodes are never erased and unordered_map nodes do not move, so
+    // the reference stays valid after the lock is released. When two threads
+    // decode the same subtree the first one stored is kept.
+    const nlohmann::json& decode(const string& ptr) const {
+        {
+            lock_guard<mutex> lock(cache_mutex);
+            auto it = cache.find(ptr);
+            if (it != cache.end()) return it->second;
+        }
+        const uint8_t* item = locate(ptr);
+        if (!item) throw ERROR("Missing key: " + ptr);
+        nlohmann::json node;
+        reader.decode(item, node);
+        lock_guard<mutex> lock(cache_mutex);
+        return cache.try_emplace(ptr, move(node)).first->second;
+    }
+
+    // Start of the CBOR item at the json_pointer text, nullptr when missing
+    const uint8_t* locate(const string& ptr) const {
+        const uint8_t* p = reader.begin;
+        for (size_t from = 1; from <= ptr.size();) {
+            size_t to = ptr.find('/', from);
+            if (to == string::npos) to = ptr.size();
+            string token = unescape(ptr.substr(from, to - from));
+            from = to + 1;
+            p = reader.tags(p);
+            uint8_t major = *p >> 5;
+            uint64_t count;
+            bool indefinite;
+            p = reader.head(p, count, indefinite);
+            bool found = false;
+            if (major == 5) {
+                for (uint64_t i = 0; indefinite ? *reader.check(p) != 0xFF : i < count; i++) {
+                    const uint8_t* key = reader.tags(p);
+                    const uint8_t* value = reader.skip(key);
+                    if ((*key >> 5) == 3) {
+                        uint64_t len;
+                        bool chunked;
+                        const uint8_t* text = reader.head(key, len, chunked);
+                        if (!chunked && len == token.size() && memcmp(text, token.data(), len) == 0) {
+                            p = value;
+                            found = true;
+                            break;
+                        }
+                    }
+                    p = reader.skip(value);
+                }
+            } else if (major == 4 && !token.empty() && token.find_first_not_of("0123456789") == string::npos) {
+                uint64_t index = stoull(token);
+                for (uint64_t i = 0; indefinite ? *reader.check(p) != 0xFF : i < count; i++) {
+                    if (i == index) {
+                        found = true;
+                        break;
+                    }
+                    p = reader.skip(p);
+                }
+            }
+            if (!found) return nullptr;
+        }
+        return p;
+    }
+
+    static string unescape(string token) {
+        for (size_t i = token.find('~'); i != string::npos; i = token.find('~', i + 1))
+            token.replace(i, 2, token[i + 1] == '1' ? "/" : "~");
+        return token;
+    }
+
+    MappedFile file;
+    CBORReader reader;
+    mutable mutex cache_mutex;
+    mutable unordered_map<string, nlohmann::json> cache;
+};
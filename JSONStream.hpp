@@ -0,0 +1,347 @@
+#pragma once
+
+#include "JSON.hpp"
+#include "ERROR.hpp"
+#include "EWHAT.hpp"
+#include "peach.hpp"
+#include <fstream>
+#include <functional>
+#include <deque>
+#include <thread>
+#include <cstring>
+#include <filesystem>
+
+using namespace std;
+
+// Record by record JSON reading with bounded memory: only the record being
+// assembled is buffered, never the whole document.
+// JSON_STREAM_LINES: newline delimited JSON (JSONL), blank lines are skipped
+// JSON_STREAM_ARRAY: a top-level array, every element is a record
+// JSON_STREAM_AUTO: array when the first non-whitespace character is '['
+enum JSONStreamFormat { JSON_STREAM_AUTO, JSON_STREAM_LINES, JSON_STREAM_ARRAY };
+
+#define JSON_STREAM_MAX_RECORD (64 * 1024 * 1024)
+#define JSON_STREAM_CHUNK_SIZE (64 * 1024)
+
+// Push interface, feed it any split of the input, e.g. from a Curl stream callback:
+//   JSONStream stream([](nlohmann::json&& record) { ... });
+//   curl.GET(url, [&stream](const string& chunk) { stream.feed(chunk); });
+//   stream.finish();
+class JSONStream {
+public:
+    using RecordCallback = function<void(nlohmann::json&& record)>;
+
+    // first_line: lines before the input, when it is a part of a file, so errors name the file's line
+    JSONStream(
+        RecordCallback callback,
+        JSONStreamFormat format = JSON_STREAM_AUTO,
+        size_t max_record = JSON_STREAM_MAX_RECORD,
+        size_t first_line = 0
+    ): callback(callback), format(format), max_record(max_record), line(first_line) {}
+
+    void feed(const string& chunk) {
+        feed(chunk.data(), chunk.size());
+    }
+
+    void feed(const char* data, size_t size) {
+        if (format == JSON_STREAM_AUTO) {
+            size_t i = 0;
+            while (i < size && is_space(data[i])) {
+                if (data[i] == '\n') line++;
+                i++;
+            }
+            if (i == size) return;
+            format = data[i] == '[' ? JSON_STREAM_ARRAY : JSON_STREAM_LINES;
+            data += i;
+            size -= i;
+        }
+        if (format == JSON_STREAM_LINES) lines(data, size);
+        else array(data, size);
+    }
+
+    // End of input: emits the last line without a newline, checks the array was closed
+    void finish() {
+        if (format == JSON_STREAM_LINES) {
+            if (!pending.empty()) {
+                string last = move(pending);
+                pending.clear();
+                record(last.data(), last.size());
+            }
+        } else if (format == JSON_STREAM_ARRAY && state != ARRAY_OPEN && state != ARRAY_DONE)
+            throw ERROR("Unterminated JSON array after " + to_string(count) + " record(s)");
+    }
+
+    size_t records() const {
+        return count;
+    }
+
+    // Line feeds seen so far, plus first_line
+    size_t lines_seen() const {
+        return line;
+    }
+
+private:
+
+    static bool is_space(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    void append(const char* data, size_t size) {
+        if (pending.size() + size > max_record)
+            throw ERROR("JSON record is larger than " + to_string(max_record) + " bytes: " + where());
+        pending.append(data, size);
+    }
+
+    string where() const {
+        return format == JSON_STREAM_LINES ? "line " + to_string(line + 1) : "record " + to_string(count + 1);
+    }
+
+    void record(const char* data, size_t size) {
+        while (size && is_space(data[size - 1])) size--;
+        while (size && is_space(*data)) {
+            data++;
+            size--;
+        }
+        if (!size) {
+            if (format == JSON_STREAM_ARRAY) throw ERROR("Empty JSON record: " + where());
+            return;
+        }
+        nlohmann::json j;
+        try {
+            j = nlohmann::json::parse(data, data + size);
+        } catch (const nlohmann::json::exception& e) {
+            throw ERROR("Invalid JSON record at " + where() + ": " + e.what());
+        }
+        count++;
+        callback(move(j));
+    }
+
+    void lines(const char* data, size_t size) {
+        while (size) {
+            const char* nl = (const char*)memchr(data, '\n', size);
+            if (!nl) {
+                append(data, size);
+                return;
+            }
+            size_t len = nl - data;
+            if (pending.empty()) record(data, len);
+            else {
+                append(data, len);
+                string full = move(pending);
+                pending.clear();
+                record(full.data(), full.size());
+            }
+            line++;
+            data += len + 1;
+            size -= len + 1;
+        }
+    }
+
+    // Finds the element boundaries of the top-level array, elements are
+    // handed to nlohmann as spans of the chunk whenever they are not split
+    void array(const char* data, size_t size) {
+        size_t from = 0;
+        for (size_t i = 0; i < size; i++) {
+            char c = data[i];
+            switch (state) {
+                case ARRAY_OPEN:
+                    if (is_space(c)) continue;
+                    if (c != '[') throw ERROR("Expected '[' at the start of the JSON array");
+                    state = ARRAY_NEXT;
+                    continue;
+                case ARRAY_NEXT:
+                    if (is_space(c)) continue;
+                    if (c == ']') {
+                        state = ARRAY_DONE;
+                        continue;
+                    }
+                    if (c == ',') throw ERROR("Unexpected ',' in JSON array: " + where());
+                    state = ARRAY_ELEMENT;
+                    depth = 0;
+                    in_string = escape = false;
+                    from = i;
+                    break; // c is the first character of the element
+                case ARRAY_DONE:
+                    if (is_space(c)) continue;
+                    throw ERROR("Unexpected data after the JSON array");
+                case ARRAY_ELEMENT:
+                    break;
+            }
+            if (in_string) {
+                if (escape) escape = false;
+                else if (c == '\\') escape = true;
+                else if (c == '"') in_string = false;
+                continue;
+            }
+            if (c == '"') in_string = true;
+            else if (c == '{' || c == '[') depth++;
+            else if (depth) {
+                if (c == '}' || c == ']') depth--;
+            } else if (c == ',' || c == ']') {
+                if (pending.empty()) record(data + from, i - from);
+                else {
+                    append(data + from, i - from);
+                    string full = move(pending);
+                    pending.clear();
+                    record(full.data(), full.size());
+                }
+                state = c == ',' ? ARRAY_NEXT : ARRAY_DONE;
+            }
+        }
+        if (state == ARRAY_ELEMENT) append(data + from, size - from);
+    }
+
+    RecordCallback callback;
+    JSONStreamFormat format;
+    size_t max_record;
+    string pending;
+    size_t count = 0;
+    size_t line = 0;
+
+    enum { ARRAY_OPEN, ARRAY_NEXT, ARRAY_ELEMENT, ARRAY_DONE } state = ARRAY_OPEN;
+    int depth = 0;
+    bool in_string = false;
+    bool escape = false;
+};
+
+// Pull interface over a file:
+//   JSONStreamReader reader("data.jsonl");
+//   nlohmann::json record;
+//   while (reader.next(record)) { ... }
+class JSONStreamReader {
+public:
+    JSONStreamReader(
+        const string& filename,
+        JSONStreamFormat format = JSON_STREAM_AUTO,
+        size_t chunk_size = JSON_STREAM_CHUNK_SIZE
+    ):
+        file(filename, ios::binary),
+        chunk(chunk_size),
+        stream([this](nlohmann::json&& record) { records.push_back(move(record)); }, format)
+    {
+        if (!file.is_open()) throw ERROR("Unable to open file: " + filename);
+    }
+
+    bool next(nlohmann::json& record) {
+        while (records.empty()) {
+            if (done) return false;
+            file.read(chunk.data(), chunk.size());
+            streamsize n = file.gcount();
+            if (n > 0) stream.feed(chunk.data(), n);
+            if (n < (streamsize)chunk.size()) {
+                stream.finish();
+                done = true;
+            }
+        }
+        record = move(records.front());
+        records.pop_front();
+        return true;
+    }
+
+private:
+    ifstream file;
+    vector<char> chunk;
+    deque<nlohmann::json> records; // at most the records of one chunk
+    JSONStream stream;
+    bool done = false;
+};
+
+// Streams every record of a file to the callback, returns the record count
+size_t json_stream_file(
+    const string& filename,
+    JSONStream::RecordCallback callback,
+    JSONStreamFormat format = JSON_STREAM_AUTO,
+    size_t chunk_size = JSON_STREAM_CHUNK_SIZE
+) {
+    ifstream file(filename, ios::binary);
+    if (!file.is_open()) throw ERROR("Unable to open file: " + filename);
+    JSONStream stream(callback, format);
+    vector<char> chunk(chunk_size);
+    while (file.read(chunk.data(), chunk.size()) || file.gcount() > 0)
+        stream.feed(chunk.data(), file.gcount());
+    stream.finish();
+    return stream.records();
+}
+
+// Parallel JSONL parsing: the file is split into one byte range per thread,
+// moved forward to the next line start, and each range is streamed on its own
+// thread. The callback is called concurrently from those threads (it has to
+// be thread safe) and records of different ranges arrive in no particular order.
+size_t jsonl_parse_parallel(
+    const string& filename,
+    JSONStream::RecordCallback callback,
+    size_t threads = 0,
+    size_t chunk_size = JSON_STREAM_CHUNK_SIZE
+) {
+    error_code ec;
+    size_t size = filesystem::file_size(filename, ec);
+    if (ec) throw ERROR("Unable to open file: " + filename);
+    if (!threads) threads = max(1u, thread::hardware_concurrency());
+    threads = max((size_t)1, min(threads, size / chunk_size + 1));
+
+    // range boundaries at line starts
+    vector<size_t> starts = { 0 };
+    ifstream file(filename, ios::binary);
+    if (!file.is_open()) throw ERROR("Unable to open file: " + filename);
+    for (size_t t = 1; t < threads; t++) {
+        size_t start = max(size * t / threads, starts.back());
+        file.clear();
+        file.seekg(start);
+        char c;
+        while (start < size && file.get(c)) {
+            start++;
+            if (c == '\n') break;
+        }
+        starts.push_back(start);
+    }
+    starts.push_back(size);
+
+    struct Range {
+        size_t from, to;
+        size_t count = 0;
+        size_t lines = 0;
+        exception_ptr error;
+    };
+    vector<Range> ranges;
+    for (size_t t = 0; t < threads; t++)
+        if (starts[t] < starts[t + 1]) ranges.push_back({ starts[t], starts[t + 1], 0, 0, nullptr });
+
+    auto stream_range = [&filename, chunk_size](Range& range, JSONStream& stream) {
+        ifstream in(filename, ios::binary);
+        in.seekg(range.from);
+        vector<char> chunk(chunk_size);
+        for (size_t left = range.to - range.from; left;) {
+            size_t n = min(left, chunk.size());
+            if (!in.read(chunk.data(), n)) throw ERROR("Unable to read file: " + filename);
+            stream.feed(chunk.data(), n);
+            left -= n;
+        }
+        stream.finish();
+    };
+
+    peach(ranges, [&](Range& range, size_t) {
+        try {
+            JSONStream stream(callback, JSON_STREAM_LINES);
+            stream_range(range, stream);
+            range.count = stream.records();
+            range.lines = stream.lines_seen();
+        } catch (...) {
+            range.error = current_exception();
+        }
+    });
+
+    size_t count = 0, lines = 0;
+    for (Range& range: ranges) {
+        if (range.error) {
+            // The ranges before this one are complete, so the line it starts
+            // at is known now: the range is read again, records ignored, for
+            // an error that names the line of the file
+            JSONStream stream([](nlohmann::json&&) {}, JSON_STREAM_LINES, JSON_STREAM_MAX_RECORD, lines);
+            stream_range(range, stream);
+            rethrow_exception(range.error); // not reproduced, e.g. thrown by the callback
+        }
+        count += range.count;
+        lines += range.lines;
+    }
+    return count;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "JSON.hpp"
+#include <functional>
+#include <map>
+#include <set>
+
+using namespace std;
+
+// Applies patches to a document in place and calls only the listeners whose
+// path overlaps a changed path: the changed node itself, one of its parents
+// or something inside it. The cost follows the size of the patch, not the
+// size of the document.
+//   JSONWatcher watcher(conf);
+//   watcher.on(".server.port", [](const JSON& conf) { ... });
+//   watcher.update(JSON(file_get_contents("conf.json")));
+class JSONWatcher {
+public:
+    using Listener = function<void(const JSON& doc)>;
+
+    JSONWatcher(JSON& doc): doc(doc) {}
+
+    // Returns an id for off()
+    size_t on(const string& jselector, Listener listener) {
+        string ptr = jselector.empty() ? "" : json_selector(jselector).to_string();
+        listeners[ptr][++last_id] = listener;
+        return last_id;
+    }
+
+    void off(size_t id) {
+        for (auto it = listeners.begin(); it != listeners.end(); ++it)
+            if (it->second.erase(id)) {
+                if (it->second.empty()) listeners.erase(it);
+                return;
+            }
+    }
+
+    // RFC 6902 patch
+    void patch(const nlohmann::json& ops) {
+        vector<string> paths;
+        for (const nlohmann::json& op: ops) {
+            if (!op.is_object() || !op.contains("op") || op["op"] == "test") continue;
+            if (op.contains("path") && op["path"].is_string()) paths.push_back(changed(op["path"]));
+            if (op["op"] == "move" && op.contains("from") && op["from"].is_string()) paths.push_back(changed(op["from"]));
+        }
+        doc.patch(ops);
+        notify(paths);
+    }
+
+    // RFC 7386 merge patch
+    void merge_patch(const nlohmann::json& changes) {
+        vector<string> paths;
+        string path;
+        merge_paths(doc.get_json_cref(), changes, path, paths);
+        doc.merge_patch(changes);
+        notify(paths);
+    }
+
+    // Brings the document to target with a diff, returns the applied patch
+    nlohmann::json update(const JSON& target) {
+        nlohmann::json ops = doc.diff(target);
+        if (!ops.empty()) patch(ops);
+        return ops;
+    }
+
+private:
+
+    // Adding or removing an array element moves the ones after it, so the
+    // whole array counts as changed
+    string changed(const string& path) const {
+        try {
+            nlohmann::json::json_pointer ptr(path);
+            if (ptr.empty()) return path;
+            nlohmann::json::json_pointer parent = ptr.parent_pointer();
+            const nlohmann::json& root = doc.get_json_cref();
+            if (root.contains(parent) && root[parent].is_array()) return parent.to_string();
+        } catch (const nlohmann::json::exception&) {
+            // invalid pointer, the patch itself reports it
+        }
+        return path;
+    }
+
+    // Paths a merge patch changes, computed before it is applied
+    static void merge_paths(const nlohmann::json& node, const nlohmann::json& changes, string& path, vector<string>& paths) {
+        if (!changes.is_object() || !node.is_object()) {
+            paths.push_back(path);
+            return;
+        }
+        size_t size = path.size();
+        for (auto it = changes.cbegin(); it != changes.cend(); ++it) {
+            json_pointer_append(path, it.key());
+            auto found = node.find(it.key());
+            if (found == node.end()) {
+                if (!it.value().is_null()) paths.push_back(path);
+            } else if (it.value().is_object()) merge_paths(*found, it.value(), path, paths);
+            else paths.push_back(path);
+            path.resize(size);
+        }
+    }
+
+    void notify(const vector<string>& paths) {
+        set<size_t> matched;
+        vector<Listener> calls; // copies, a listener may call on() or off()
+        auto add = [&](const map<size_t, Listener>& group) {
+            for (const auto& [id, listener]: group)
+                if (matched.insert(id).second) calls.push_back(listener);
+        };
+        for (const string& path: paths) {
+            // the path itself and its parents
+            for (size_t at = 0; at != string::npos; at = path.find('/', at + 1)) {
+                auto it = listeners.find(path.substr(0, at));
+                if (it != listeners.end()) add(it->second);
+            }
+            auto it = listeners.find(path);
+            if (it != listeners.end()) add(it->second);
+            // everything inside it: keys from path + "/" up to path + "0" ('/' + 1)
+            auto from = listeners.lower_bound(path + "/");
+            auto to = listeners.lower_bound(path + "0");
+            for (auto inside = from; inside != to; ++inside) add(inside->second);
+        }
+        for (const Listener& listener: calls) listener(doc);
+    }
+
+    JSON& doc;
+    map<string, map<size_t, Listener>> listeners;
+    size_t last_id = 0;
+};
@@ -1,6 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <map>
+#include <array>
+#include <unordered_map>
+#include <vector>
+#include <memory>
+#include <random>
+#include <thread>
 #include <atomic>
 #include <mutex>
 #include <string>
@@ -55,14 +62,81 @@ static const map<LogLevel, string> logLevelMap = {
     { LOGLVL_DEBUG, F(F_DEBUG, "debug") },
 };
 
+// Counts of messages the Logger did not write
+struct LogSuppressed {
+    size_t limited = 0; // dropped by the per call-site rate limit
+    size_t sampled = 0; // dropped by probabilistic sampling
+    size_t collapsed = 0; // folded into a "repeated N times" line
+    size_t dropped = 0; // dropped by a full sink queue (TeeLogger)
+};
+
+class Logger;
+
+// Rate limit state of a call site, shared by all threads. The bucket is one
+// theoretical arrival time (GCRA) moved forward by compare and swap, no lock.
+struct LogSite {
+    atomic<int64_t> tat = 0; // steady clock ns when the bucket is full again
+    atomic<size_t> limited = 0;
+};
+
+// Throttling state of one thread, only the owner thread writes it
+// so the counters are bumped with relaxed load/store instead of RMW atomics.
+// The collapse state is locked, flush_repeats() may write it from any thread.
+struct LogThreadBuffer {
+    minstd_rand random{ (unsigned)hash<thread::id>()(this_thread::get_id()) };
+    unordered_map<string, LogSite*> sites; // call sites this thread has seen, keyed by FILELN
+    mutex mtx;
+    Logger* owner = nullptr; // cleared when the logger shuts down
+    LogLevel last_level = LOGLVL_NONE;
+    string last_message;
+    string last_fileln;
+    size_t repeated = 0;
+    atomic<size_t> limited = 0;
+    atomic<size_t> sampled = 0;
+    atomic<size_t> collapsed = 0;
+
+    static void count(atomic<size_t>& counter) {
+        counter.store(counter.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    }
+};
+
 class Logger {
+    friend class TeeLogger;
 public:
     Logger() {}
-    virtual ~Logger() {}
+    virtual ~Logger() { detach(false); }
 
     void set_level_output(LogLevel level_output) { this->level_output = level_output; } 
     void set_level_fileln(LogLevel level_fileln) { this->level_fileln = level_fileln; } 
 
+    // Token bucket per call site (FILELN) shared by all threads, 0 turns it off
+    void set_rate_limit(double per_second, double burst = 1) { this->rate_burst = burst; this->rate_limit = per_second; }
+    // Keeps only the given ratio of messages at level_sampling and above (the debug levels by default)
+    void set_sampling(double sampling, LogLevel level_sampling = LOGLVL_DEBUG) { this->level_sampling = level_sampling; this->sampling = sampling; }
+    // Identical consecutive messages of a thread are written once, followed by a "repeated N times" line
+    // when a different message comes, the thread exits or the logger shuts down
+    void set_collapse(bool collapse) { this->collapse = collapse; }
+
+    // Writes the "repeated N times" lines still pending on any thread
+    void flush_repeats() {
+        lock_guard<mutex> lock(buffers_mtx);
+        for (const shared_ptr<LogThreadBuffer>& buffer: buffers) {
+            lock_guard<mutex> buffer_lock(buffer->mtx);
+            repeat(*buffer);
+        }
+    }
+
+    virtual LogSuppressed suppressed() {
+        LogSuppressed result;
+        lock_guard<mutex> lock(buffers_mtx);
+        for (const shared_ptr<LogThreadBuffer>& buffer: buffers) {
+            result.limited += buffer->limited.load(memory_order_relaxed);
+            result.sampled += buffer->sampled.load(memory_order_relaxed);
+            result.collapsed += buffer->collapsed.load(memory_order_relaxed);
+        }
+        return result;
+    }
+
     void throws(const string& message, const string& fileln, bool throws = true) { log(LOGLVL_THROW, message, fileln, throws); }
     void error(const string& message, const string& fileln, bool throws = false) { log(LOGLVL_ERROR, message, fileln, throws); }
     void alert(const string& message, const string& fileln, bool throws = false) { log(LOGLVL_ALERT, message, fileln, throws); }
@@ -74,37 +148,181 @@ public:
 
 protected:
 
+    // Loggers call it first in their destructor, while write() still works:
+    // pending repeat lines are written and exiting threads leave the logger alone
+    void shutdown() { detach(true); }
+
     virtual void log(LogLevel level, const string& message, const string& fileln, bool throws = false) {
         if (level > LOGLVL_NONE && level <= this->level_output) {
-            string output = "[" + logLevelMap.at(level == LOGLVL_ALL ? LOGLVL_THROW : level) + "] " + message;            
-            
-            if (level == LOGLVL_ALL)
-                throw ERROR("Logger can not write to all level (LOGLVL_ALL): " + output);
-            
-            if (level <= this->level_fileln || level == LOGLVL_DEBUG) {
-                output += fileln;
-            }
+            string note;
+            bool throttled = rate_limit > 0 || sampling < 1 || collapse;
+            if (throttled && level != LOGLVL_THROW && level != LOGLVL_ALL && !throws && !pass(level, message, fileln, note))
+                return;
 
-            string time = this->time();
-            if (!time.empty())
-                output = time + " " + output;
+            string output = format(level, message + note, fileln);
 
-            {
-                lock_guard<mutex> lock(mtx);
-                this->write(output);
-            }
+            this->dispatch(level, output);
 
             if (level == LOGLVL_THROW || throws)
                 throw ERROR("Logger throws: " + output);
         }
     }
 
+    string format(LogLevel level, const string& message, const string& fileln) {
+        string output = "[" + logLevelMap.at(level == LOGLVL_ALL ? LOGLVL_THROW : level) + "] " + message;            
+        
+        if (level == LOGLVL_ALL)
+            throw ERROR("Logger can not write to all level (LOGLVL_ALL): " + output);
+        
+        if (level <= this->level_fileln || level == LOGLVL_DEBUG) {
+            output += fileln;
+        }
+
+        string time = this->time();
+        if (!time.empty())
+            output = time + " " + output;
+
+        return output;
+    }
+
+    // Decides on the thread's own buffer whether a message gets written,
+    // note is set when a call site had suppressed messages before this one
+    bool pass(LogLevel level, const string& message, const string& fileln, string& note) {
+        LogThreadBuffer& buffer = this->buffer();
+        bool collapsing = collapse;
+        unique_lock<mutex> lock(buffer.mtx, defer_lock);
+
+        if (collapsing) {
+            lock.lock();
+            if (buffer.last_level == level && buffer.last_fileln == fileln && buffer.last_message == message) {
+                buffer.repeated++;
+                LogThreadBuffer::count(buffer.collapsed);
+                return false;
+            }
+            repeat(buffer); // a different message ends the repeats, even when it is dropped below
+        }
+
+        if (sampling < 1 && level >= level_sampling && uniform_real_distribution<double>(0, 1)(buffer.random) >= sampling) {
+            LogThreadBuffer::count(buffer.sampled);
+            return false;
+        }
+
+        double rate = rate_limit;
+        if (rate > 0) {
+            LogSite*& site = buffer.sites[fileln];
+            if (!site) site = &this->site(fileln);
+            // a message moves the arrival time one interval on, it passes
+            // while that stays within burst intervals from now
+            int64_t interval = (int64_t)min(1e18, 1e9 / rate);
+            int64_t tolerance = (int64_t)min(1e18, rate_burst * 1e9 / rate);
+            int64_t now = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+            int64_t tat = site->tat.load(memory_order_relaxed), next;
+            do {
+                next = max(tat, now) + interval;
+                if (next - now > tolerance) {
+                    site->limited.fetch_add(1, memory_order_relaxed);
+                    LogThreadBuffer::count(buffer.limited);
+                    return false;
+                }
+            } while (!site->tat.compare_exchange_weak(tat, next, memory_order_relaxed));
+            if (site->limited.load(memory_order_relaxed)) {
+                size_t limited = site->limited.exchange(0, memory_order_relaxed);
+                if (limited) note = " (" + to_string(limited) + " similar message(s) suppressed)";
+            }
+        }
+
+        if (collapsing) {
+            buffer.last_level = level;
+            buffer.last_message = message;
+            buffer.last_fileln = fileln;
+            buffer.repeated = 0;
+        }
+
+        return true;
+    }
+
+    // The shared bucket of a call site, locked only the first time a thread meets it
+    LogSite& site(const string& fileln) {
+        SiteShard& shard = site_shards[hash<string>()(fileln) % site_shards.size()];
+        lock_guard<mutex> lock(shard.mtx);
+        return shard.sites.try_emplace(fileln).first->second;
+    }
+
+    // Writes the pending repeat line of a buffer, buffer.mtx is held
+    void repeat(LogThreadBuffer& buffer) {
+        if (!buffer.repeated) return;
+        size_t repeated = buffer.repeated;
+        buffer.repeated = 0;
+        this->dispatch(buffer.last_level, format(buffer.last_level, "Last message repeated " + to_string(repeated) + " times", buffer.last_fileln));
+    }
+
+    void detach(bool flush) {
+        lock_guard<mutex> lock(buffers_mtx);
+        for (const shared_ptr<LogThreadBuffer>& buffer: buffers) {
+            lock_guard<mutex> buffer_lock(buffer->mtx);
+            if (flush) repeat(*buffer);
+            buffer->owner = nullptr;
+        }
+    }
+
+    // Owned by the thread, writes its pending repeat line when the thread exits
+    struct ThreadBuffer {
+        shared_ptr<LogThreadBuffer> buffer;
+        ~ThreadBuffer() {
+            if (!buffer) return;
+            lock_guard<mutex> lock(buffer->mtx);
+            if (!buffer->owner) return;
+            try {
+                buffer->owner->repeat(*buffer);
+            } catch (...) {} // the thread is gone, nowhere to report
+        }
+    };
+
+    LogThreadBuffer& buffer() {
+        static thread_local unordered_map<size_t, ThreadBuffer> thread_buffers;
+        shared_ptr<LogThreadBuffer>& buffer = thread_buffers[id].buffer;
+        if (!buffer) {
+            buffer = make_shared<LogThreadBuffer>();
+            buffer->owner = this;
+            lock_guard<mutex> lock(buffers_mtx);
+            buffers.push_back(buffer);
+        }
+        return *buffer;
+    }
+
+    static size_t next_id() {
+        static atomic<size_t> ids = 0;
+        return ++ids;
+    }
+
+    // Hands a formatted record to the output, TeeLogger overrides it to fan out
+    virtual void dispatch(LogLevel, const string& output) {
+        lock_guard<mutex> lock(mtx);
+        this->write(output);
+    }
+
     virtual void write(const string& output) = 0;
     virtual string time() { return ms_to_datetime(); }
     
     atomic<LogLevel> level_output = LOG_LEVEL_OUTPUT;
     atomic<LogLevel> level_fileln = LOG_LEVEL_FILELN;
     mutex mtx;
+
+    atomic<double> rate_limit = 0;
+    atomic<double> rate_burst = 1;
+    atomic<double> sampling = 1;
+    atomic<LogLevel> level_sampling = LOGLVL_DEBUG;
+    atomic<bool> collapse = false;
+    const size_t id = next_id();
+    mutex buffers_mtx;
+    vector<shared_ptr<LogThreadBuffer>> buffers;
+
+    // Rate limit buckets by call site, the nodes stay put so threads keep pointers to them
+    struct SiteShard {
+        mutex mtx;
+        unordered_map<string, LogSite> sites; // keyed by FILELN
+    };
+    array<SiteShard, 16> site_shards;
 };
 
 class LoggerFactory {
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "ERROR.hpp"
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Read-only memory mapping of a whole file, unmapped on destruction.
+// sequential: the file is read front to back once, lets the kernel read ahead
+// populate: fault every page in up front (MAP_POPULATE) instead of on first access
+class MappedFile {
+public:
+    MappedFile(const string& filename, bool sequential = false, bool populate = false) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) throw ERROR("Unable to open file: " + filename);
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw ERROR("Unable to stat file: " + filename);
+        }
+        _size = st.st_size;
+        if (_size) {
+            int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+            if (populate) flags |= MAP_POPULATE;
+#else
+            (void)populate;
+#endif
+            void* p = mmap(nullptr, _size, PROT_READ, flags, fd, 0);
+            ::close(fd);
+            if (p == MAP_FAILED) throw ERROR("Unable to map file: " + filename);
+            if (sequential) madvise(p, _size, MADV_SEQUENTIAL);
+            _data = (const char*)p;
+        } else ::close(fd);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept : _data(other._data), _size(other._size) {
+        other._data = nullptr;
+        other._size = 0;
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            if (_data) munmap((void*)_data, _size);
+            _data = other._data;
+            _size = other._size;
+            other._data = nullptr;
+            other._size = 0;
+        }
+        return *this;
+    }
+
+    ~MappedFile() {
+        if (_data) munmap((void*)_data, _size);
+    }
+
+    const char* data() const {
+        return _data;
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+private:
+    const char* _data = nullptr;
+    size_t _size = 0;
+};
+
+// Writable shared mapping of a new file of a fixed size, written back and
+// unmapped on destruction. The file is created or truncated.
+class MappedOutputFile {
+public:
+    MappedOutputFile(const string& filename, size_t size): _size(size) {
+        int fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw ERROR("Unable to open file for writing: " + filename);
+        if (ftruncate(fd, _size) != 0) {
+            ::close(fd);
+            throw ERROR("Unable to resize file: " + filename);
+        }
+        if (_size) {
+            void* p = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (p == MAP_FAILED) throw ERROR("Unable to map file: " + filename);
+            _data = (char*)p;
+        } else ::close(fd);
+    }
+
+    MappedOutputFile(const MappedOutputFile&) = delete;
+    MappedOutputFile& operator=(const MappedOutputFile&) = delete;
+
+    ~MappedOutputFile() {
+        if (_data) munmap(_data, _size);
+    }
+
+    char* data() {
+        return _data;
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+private:
+    char* _data = nullptr;
+    size_t _size = 0;
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "ERROR.hpp"
+#include "MappedFile.hpp"
+#include "crc32c.hpp"
+#include <span>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include <cerrno>
+
+using namespace std;
+
+// File layout of the mapped vectors: this header, then count elements as
+// they are in memory. 32 bytes keep the data aligned for any T up to 32.
+struct MappedVectorHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t element_size;
+    uint32_t crc;       // crc32c() of the data
+    uint64_t count;
+    uint64_t tag;       // set by the writer, pairs files written together (0 = none)
+
+    static constexpr const char* MAGIC = "VECM";
+    static constexpr uint32_t VERSION = 1;
+
+    static MappedVectorHeader make(size_t element_size, uint64_t count, uint32_t crc, uint64_t tag = 0) {
+        MappedVectorHeader header = {};
+        memcpy(header.magic, MAGIC, 4);
+        header.version = VERSION;
+        header.element_size = element_size;
+        header.crc = crc;
+        header.count = count;
+        header.tag = tag;
+        return header;
+    }
+
+    void check(size_t element_size, size_t file_size, const string& filename) const {
+        if (memcmp(magic, MAGIC, 4) != 0)
+            throw ERROR("Not a mapped vector file: " + filename);
+        if (version != VERSION)
+            throw ERROR("Unsupported mapped vector version " + to_string(version) + ": " + filename);
+        if (this->element_size != element_size)
+            throw ERROR("Mapped vector element size mismatch, " + to_string(this->element_size) + " != " + to_string(element_size) + ": " + filename);
+        // an interrupted append may leave bytes after the data, the header only counts complete ones
+        if ((file_size - sizeof(MappedVectorHeader)) / element_size < count)
+            throw ERROR("Mapped vector file is truncated: " + filename);
+    }
+};
+
+static_assert(sizeof(MappedVectorHeader) == 32, "MappedVectorHeader must be 32 bytes");
+
+// Read-only view of a vector file written by vector_save_mapped(), the
+// elements are used in place from the mapping, nothing is copied or
+// zero-filled. Pages are read on first access unless populate is set.
+// The checksum is only computed by verify() (or with verify = true), a full
+// pass over the data is what the mapping avoids.
+//   MappedVector<float> samples("samples.vec");
+//   for (float x: samples) ...
+template<typename T>
+class MappedVector {
+    static_assert(is_trivially_copyable_v<T>, "MappedVector<T> needs a trivially copyable T");
+    static_assert(alignof(T) <= sizeof(MappedVectorHeader), "MappedVector<T> data is 32 byte aligned");
+public:
+    MappedVector(const string& filename, bool populate = false, bool verify = false):
+        file(filename, false, populate), filename(filename)
+    {
+        if (file.size() < sizeof(MappedVectorHeader))
+            throw ERROR("Not a mapped vector file: " + filename);
+        memcpy(&header, file.data(), sizeof(header));
+        header.check(sizeof(T), file.size(), filename);
+        items = span<const T>((const T*)(file.data() + sizeof(MappedVectorHeader)), header.count);
+        if (verify && !this->verify())
+            throw ERROR("Mapped vector checksum mismatch: " + filename);
+    }
+
+    bool verify() const {
+        return crc32c(items.data(), items.size_bytes()) == header.crc;
+    }
+
+    span<const T> view() const { return items; }
+    const T* data() const { return items.data(); }
+    size_t size() const { return items.size(); }
+    bool empty() const { return items.empty(); }
+    uint64_t tag() const { return header.tag; }
+    const T& operator[](size_t at) const { return items[at]; }
+    typename span<const T>::iterator begin() const { return items.begin(); }
+    typename span<const T>::iterator end() const { return items.end(); }
+
+private:
+    MappedFile file;
+    string filename;
+    MappedVectorHeader header;
+    span<const T> items;
+};
+
+// Writes a temp file next to filename and renames it over, readers see the
+// old file or the new one, never a partial write
+template<typename T>
+void vector_save_mapped(span<const T> items, const string& filename, uint64_t tag = 0) {
+    static_assert(is_trivially_copyable_v<T>, "vector_save_mapped() needs a trivially copyable T");
+    string tmp = filename + ".tmp";
+    {
+        MappedOutputFile out(tmp, sizeof(MappedVectorHeader) + items.size_bytes());
+        MappedVectorHeader header = MappedVectorHeader::make(sizeof(T), items.size(), crc32c(items.data(), items.size_bytes()), tag);
+        memcpy(out.data(), &header, sizeof(header));
+        if (!items.empty()) memcpy(out.data() + sizeof(header), items.data(), items.size_bytes());
+    }
+    if (::rename(tmp.c_str(), filename.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        throw ERROR("Unable to rename mapped vector file: " + tmp + " -> " + filename);
+    }
+}
+
+template<typename T>
+void vector_save_mapped(const vector<T>& items, const string& filename, uint64_t tag = 0) {
+    vector_save_mapped(span<const T>(items), filename, tag);
+}
+
+// Appends to a vector file (created when missing) without rewriting it: the
+// data goes after the last complete element, then the header is updated
+// with the new count and the checksum continued over the new data only.
+// Not atomic, but an interrupted append leaves the previous content valid.
+template<typename T>
+void vector_append_mapped(span<const T> items, const string& filename) {
+    static_assert(is_trivially_copyable_v<T>, "vector_append_mapped() needs a trivially copyable T");
+    int fd = ::open(filename.c_str(), O_RDWR);
+    if (fd < 0) {
+        if (errno != ENOENT) throw ERROR("Unable to open file for appending: " + filename);
+        vector_save_mapped(items, filename);
+        return;
+    }
+    auto fail = [&](const string& message) {
+        ::close(fd);
+        throw ERROR(message + ": " + filename);
+    };
+    MappedVectorHeader header;
+    struct stat st;
+    if (fstat(fd, &st) != 0) fail("Unable to stat file");
+    if ((size_t)st.st_size < sizeof(header) || pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header))
+        fail("Not a mapped vector file");
+    try {
+        header.check(sizeof(T), st.st_size, filename);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    off_t end = sizeof(header) + header.count * sizeof(T);
+    const char* p = (const char*)items.data();
+    size_t left = items.size_bytes();
+    for (off_t at = end; left;) {
+        ssize_t written = pwrite(fd, p, left, at);
+        if (written <= 0) fail("Unable to append to file");
+        p += written;
+        at += written;
+        left -= written;
+    }
+    if (ftruncate(fd, end + items.size_bytes()) != 0) fail("Unable to resize file");
+    header.crc = crc32c(items.data(), items.size_bytes(), header.crc);
+    header.count += items.size();
+    if (pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) fail("Unable to update the header");
+    ::close(fd);
+}
+
+template<typename T>
+void vector_append_mapped(const vector<T>& items, const string& filename) {
+    vector_append_mapped(span<const T>(items), filename);
+}
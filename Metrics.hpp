@@ -0,0 +1,385 @@
+#pragma once
+
+#include "ERROR.hpp"
+#include "EWHAT.hpp"
+#include "Stopper.hpp"
+#include "datetime_defs.hpp"
+#include "file_put_contents.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <array>
+#include <limits>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cctype>
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+
+// Bumps a counter owned by one thread without an RMW atomic,
+// readers on other threads only ever load it
+inline void metrics_bump(atomic<uint64_t>& cell, uint64_t n = 1) {
+    cell.store(cell.load(memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+// Base of the metrics that keep one shard per thread and merge them on read.
+// A thread finds its shard by the metric id in a thread_local vector,
+// registration (the first record from a thread) is the only locked step.
+template<typename S>
+class MetricsSharded {
+public:
+    MetricsSharded(const string& name, const string& help = ""): name(name), help(help) {}
+    virtual ~MetricsSharded() {}
+
+    const string name;
+    const string help;
+
+protected:
+
+    S& shard() {
+        static thread_local vector<S*> shards;
+        if (id >= shards.size()) shards.resize(id + 1, nullptr);
+        S*& shard = shards[id];
+        if (!shard) {
+            lock_guard<mutex> lock(mtx);
+            shard = owned.emplace_back(make_unique<S>()).get();
+        }
+        return *shard;
+    }
+
+    template<typename F>
+    void each(F callback) const {
+        lock_guard<mutex> lock(mtx);
+        for (const unique_ptr<S>& shard: owned) callback(*shard);
+    }
+
+private:
+    static size_t next_id() {
+        static atomic<size_t> ids = 0;
+        return ids++;
+    }
+
+    const size_t id = next_id();
+    mutable mutex mtx;
+    vector<unique_ptr<S>> owned;
+};
+
+struct MetricsCounterShard {
+    atomic<uint64_t> value = 0;
+};
+
+class MetricsCounter: public MetricsSharded<MetricsCounterShard> {
+public:
+    using MetricsSharded::MetricsSharded;
+
+    void add(uint64_t n = 1) { metrics_bump(shard().value, n); }
+
+    uint64_t value() const {
+        uint64_t sum = 0;
+        each([&sum](const MetricsCounterShard& shard) { sum += shard.value.load(memory_order_relaxed); });
+        return sum;
+    }
+};
+
+// Last written value wins, so a single atomic is enough
+class MetricsGauge {
+public:
+    MetricsGauge(const string& name, const string& help = ""): name(name), help(help) {}
+
+    void set(double value) { this->gauge.store(value, memory_order_relaxed); }
+    void add(double value) { this->gauge.fetch_add(value, memory_order_relaxed); }
+    double value() const { return gauge.load(memory_order_relaxed); }
+
+    const string name;
+    const string help;
+
+private:
+    atomic<double> gauge = 0;
+};
+
+// HDR style log-linear buckets: exact below 16, above that every power of two
+// is split into 16 sub-buckets, so a bucket is within ~6% of the recorded value
+struct MetricsHistogramShard {
+    static constexpr size_t sub_buckets = 16;
+    static constexpr size_t buckets = (64 - 4 + 1) * sub_buckets;
+    array<atomic<uint64_t>, buckets> counts = {};
+    atomic<uint64_t> count = 0;
+    atomic<uint64_t> sum = 0;
+    atomic<uint64_t> min = numeric_limits<uint64_t>::max();
+    atomic<uint64_t> max = 0;
+
+    static size_t bucket(uint64_t value) {
+        if (value < sub_buckets) return value;
+        size_t shift = 63 - __builtin_clzll(value) - 4;
+        return (shift + 1) * sub_buckets + ((value >> shift) & (sub_buckets - 1));
+    }
+
+    static uint64_t lowest(size_t bucket) {
+        if (bucket < sub_buckets) return bucket;
+        size_t shift = bucket / sub_buckets - 1;
+        return (sub_buckets + bucket % sub_buckets) << shift;
+    }
+
+    static uint64_t highest(size_t bucket) {
+        if (bucket < sub_buckets) return bucket;
+        return lowest(bucket) + ((uint64_t(1) << (bucket / sub_buckets - 1)) - 1);
+    }
+};
+
+class MetricsHistogram: public MetricsSharded<MetricsHistogramShard> {
+public:
+    using MetricsSharded::MetricsSharded;
+
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t min = 0;
+        uint64_t max = 0;
+        vector<uint64_t> counts = vector<uint64_t>(MetricsHistogramShard::buckets, 0);
+
+        double mean() const { return count ? (double)sum / (double)count : 0; }
+
+        // Upper bound of the bucket holding the q-th quantile (0 <= q <= 1)
+        uint64_t percentile(double q) const {
+            if (!count) return 0;
+            uint64_t rank = (uint64_t)(q * (double)count + 0.5);
+            if (rank < 1) rank = 1;
+            uint64_t seen = 0;
+            for (size_t i = 0; i < counts.size(); i++) {
+                seen += counts[i];
+                if (seen >= rank)
+                    return std::min(MetricsHistogramShard::highest(i), max);
+            }
+            return max;
+        }
+    };
+
+    void record(uint64_t value) {
+        MetricsHistogramShard& shard = this->shard();
+        metrics_bump(shard.counts[MetricsHistogramShard::bucket(value)]);
+        metrics_bump(shard.count);
+        metrics_bump(shard.sum, value);
+        if (value < shard.min.load(memory_order_relaxed)) shard.min.store(value, memory_order_relaxed);
+        if (value > shard.max.load(memory_order_relaxed)) shard.max.store(value, memory_order_relaxed);
+    }
+
+    Snapshot snapshot() const {
+        Snapshot result;
+        result.min = numeric_limits<uint64_t>::max();
+        each([&result](const MetricsHistogramShard& shard) {
+            result.count += shard.count.load(memory_order_relaxed);
+            result.sum += shard.sum.load(memory_order_relaxed);
+            result.min = std::min(result.min, shard.min.load(memory_order_relaxed));
+            result.max = std::max(result.max, shard.max.load(memory_order_relaxed));
+            for (size_t i = 0; i < MetricsHistogramShard::buckets; i++)
+                result.counts[i] += shard.counts[i].load(memory_order_relaxed);
+        });
+        if (!result.count) result.min = 0;
+        return result;
+    }
+};
+
+// Records the lifetime of the scope into a histogram, in nanoseconds
+class MetricsTimer: public Stopper {
+public:
+    MetricsTimer(MetricsHistogram& histogram): Stopper(true), histogram(histogram) {}
+
+    virtual ~MetricsTimer() {
+        if (started) stop();
+        histogram.record((uint64_t)elapsed);
+    }
+
+private:
+    MetricsHistogram& histogram;
+};
+
+enum MetricsFormat {
+    METRICS_PROMETHEUS,
+    METRICS_JSON
+};
+
+class Metrics {
+public:
+    Metrics() {}
+
+    virtual ~Metrics() {
+        {
+            lock_guard<mutex> lock(exporter_mtx);
+            exporting = false;
+        }
+        exporter_cv.notify_all();
+        if (exporter.joinable()) exporter.join();
+    }
+
+    // Metrics are created on the first call and live as long as the registry,
+    // keep the returned reference in hot code instead of looking it up by name
+    MetricsCounter& counter(const string& name, const string& help = "") { return get(counters, name, help); }
+    MetricsGauge& gauge(const string& name, const string& help = "") { return get(gauges, name, help); }
+    MetricsHistogram& histogram(const string& name, const string& help = "") { return get(histograms, name, help); }
+
+    string snapshot(MetricsFormat format = METRICS_PROMETHEUS) {
+        lock_guard<mutex> lock(mtx);
+        return format == METRICS_JSON ? json() : prometheus();
+    }
+
+    // Writes a snapshot into the file (temp file + rename) every interval on a background thread
+    void export_every(const string& filename, time_ms interval, MetricsFormat format = METRICS_PROMETHEUS) {
+        if (exporter.joinable())
+            throw ERROR("Metrics are already exported");
+        exporting = true;
+        exporter = thread([this, filename, interval, format]() {
+            unique_lock<mutex> lock(exporter_mtx);
+            while (!exporter_cv.wait_for(lock, chrono::milliseconds(interval), [this]() { return !exporting; })) {
+                try {
+                    save(filename, format);
+                } catch (exception& e) {
+                    cerr << "Metrics export failed: " << filename << EWHAT << endl;
+                }
+            }
+        });
+    }
+
+    void save(const string& filename, MetricsFormat format = METRICS_PROMETHEUS) {
+        string tmp = filename + ".tmp";
+        file_put_contents(tmp, snapshot(format), false, true);
+        if (::rename(tmp.c_str(), filename.c_str()) != 0)
+            throw ERROR("Unable to rename metrics file: " + tmp + " -> " + filename);
+    }
+
+private:
+
+    template<typename M>
+    M& get(map<string, unique_ptr<M>>& metrics, const string& name, const string& help) {
+        lock_guard<mutex> lock(mtx);
+        unique_ptr<M>& metric = metrics[name];
+        if (!metric) metric = make_unique<M>(name, help);
+        return *metric;
+    }
+
+    // Prometheus metric names only allow [a-zA-Z0-9_:]
+    static string sanitize(const string& name) {
+        string result = name;
+        for (char& c: result)
+            if (!isalnum((unsigned char)c) && c != '_' && c != ':') c = '_';
+        if (!result.empty() && isdigit((unsigned char)result[0])) result = "_" + result;
+        return result;
+    }
+
+    static string escape(const string& str) {
+        string result;
+        for (char c: str) {
+            if (c == '"' || c == '\\') result += '\\';
+            result += c;
+        }
+        return result;
+    }
+
+    // JSON has no NaN or infinities, they are exported as null
+    static string number(double value) {
+        if (!isfinite(value)) return "null";
+        ostringstream oss;
+        oss << setprecision(17) << value;
+        return oss.str();
+    }
+
+    // The Prometheus text format spells them NaN, +Inf and -Inf
+    static string prometheus_number(double value) {
+        if (isnan(value)) return "NaN";
+        if (isinf(value)) return value > 0 ? "+Inf" : "-Inf";
+        return number(value);
+    }
+
+    // HELP text escapes backslashes and line feeds
+    static string prometheus_help(const string& id, const string& help) {
+        if (help.empty()) return "";
+        string result = "# HELP " + id + " ";
+        for (char c: help) {
+            if (c == '\\') result += "\\\\";
+            else if (c == '\n') result += "\\n";
+            else result += c;
+        }
+        return result + "\n";
+    }
+
+    string prometheus() const {
+        const vector<double> quantiles = { 0.5, 0.9, 0.99, 0.999 };
+        string result;
+        for (const auto& [name, counter]: counters) {
+            string id = sanitize(name);
+            result += prometheus_help(id, counter->help);
+            result += "# TYPE " + id + " counter\n" + id + " " + to_string(counter->value()) + "\n";
+        }
+        for (const auto& [name, gauge]: gauges) {
+            string id = sanitize(name);
+            result += prometheus_help(id, gauge->help);
+            result += "# TYPE " + id + " gauge\n" + id + " " + prometheus_number(gauge->value()) + "\n";
+        }
+        for (const auto& [name, histogram]: histograms) {
+            string id = sanitize(name);
+            MetricsHistogram::Snapshot snapshot = histogram->snapshot();
+            result += prometheus_help(id, histogram->help);
+            result += "# TYPE " + id + " summary\n";
+            for (double q: quantiles)
+                result += id + "{quantile=\"" + number(q) + "\"} " + to_string(snapshot.percentile(q)) + "\n";
+            result += id + "_sum " + to_string(snapshot.sum) + "\n";
+            result += id + "_count " + to_string(snapshot.count) + "\n";
+        }
+        return result;
+    }
+
+    string json() const {
+        string result = "{\"counters\":{";
+        string sep = "";
+        for (const auto& [name, counter]: counters) {
+            result += sep + "\"" + escape(name) + "\":" + to_string(counter->value());
+            sep = ",";
+        }
+        result += "},\"gauges\":{";
+        sep = "";
+        for (const auto& [name, gauge]: gauges) {
+            result += sep + "\"" + escape(name) + "\":" + number(gauge->value());
+            sep = ",";
+        }
+        result += "},\"histograms\":{";
+        sep = "";
+        for (const auto& [name, histogram]: histograms) {
+            MetricsHistogram::Snapshot snapshot = histogram->snapshot();
+            result += sep + "\"" + escape(name) + "\":{"
+                "\"count\":" + to_string(snapshot.count) + ","
+                "\"sum\":" + to_string(snapshot.sum) + ","
+                "\"min\":" + to_string(snapshot.min) + ","
+                "\"max\":" + to_string(snapshot.max) + ","
+                "\"mean\":" + number(snapshot.mean()) + ","
+                "\"p50\":" + to_string(snapshot.percentile(0.5)) + ","
+                "\"p90\":" + to_string(snapshot.percentile(0.9)) + ","
+                "\"p99\":" + to_string(snapshot.percentile(0.99)) + ","
+                "\"p999\":" + to_string(snapshot.percentile(0.999)) + "}";
+            sep = ",";
+        }
+        return result + "}}";
+    }
+
+    mutex mtx;
+    map<string, unique_ptr<MetricsCounter>> counters;
+    map<string, unique_ptr<MetricsGauge>> gauges;
+    map<string, unique_ptr<MetricsHistogram>> histograms;
+
+    thread exporter;
+    mutex exporter_mtx;
+    condition_variable exporter_cv;
+    bool exporting = false;
+};
+
+// Process wide registry, the same way logger() gives the process wide Logger
+Metrics& metrics() {
+    static Metrics registry;
+    return registry;
+}
@@ -3,6 +3,8 @@
 #include "Logger.hpp"
 
 class NullLogger: public Logger {
+public:
+    virtual ~NullLogger() { shutdown(); }
 protected:
     inline void write(const string&) override {}
 };
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "ERROR.hpp"
+#include <vector>
+#include <span>
+#include <string>
+#include <algorithm>
+
+using namespace std;
+
+// Read cursor over serialized slots, replaces passing a size_t& nxt around.
+// Every read is bounds checked.
+template<typename S>
+class SerialReader {
+public:
+    SerialReader(span<const S> in, size_t at = 0): in(in), at(at) {}
+    SerialReader(const vector<S>& in, size_t at = 0): in(in.data(), in.size()), at(at), source(&in) {}
+
+    S read() {
+        need(1);
+        return in[at++];
+    }
+
+    span<const S> read(size_t size) {
+        need(size);
+        span<const S> slots = in.subspan(at, size);
+        at += size;
+        return slots;
+    }
+
+    // The slots not read yet, the cursor stays
+    span<const S> rest() const {
+        return in.subspan(min(at, in.size()));
+    }
+
+    void skip(size_t size) {
+        need(size);
+        at += size;
+    }
+
+    // The vector read from, nullptr when reading a span
+    const vector<S>* vector_source() const {
+        return source;
+    }
+
+    size_t position() const {
+        return at;
+    }
+
+    size_t remaining() const {
+        return in.size() - at;
+    }
+
+    bool done() const {
+        return at >= in.size();
+    }
+
+private:
+    void need(size_t size) const {
+        if (at > in.size() || in.size() - at < size)
+            throw ERROR("Serialized data is truncated at " + to_string(at) + ", " + to_string(size) + " more expected");
+    }
+
+    span<const S> in;
+    size_t at;
+    const vector<S>* source = nullptr;
+};
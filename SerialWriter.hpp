@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <span>
+
+using namespace std;
+
+// Appends serialized slots to a caller owned vector, growing its capacity
+// geometrically (or once, when reserve() is given the size_hint() up front).
+// One writer is passed through a whole object graph, so nothing is
+// allocated per object and nothing is copied twice.
+template<typename S>
+class SerialWriter {
+public:
+    SerialWriter(vector<S>& out): out(out) {}
+
+    void reserve(size_t size) {
+        out.reserve(out.size() + size);
+    }
+
+    void write(S slot) {
+        out.push_back(slot);
+    }
+
+    void write(span<const S> slots) {
+        out.insert(out.end(), slots.begin(), slots.end());
+    }
+
+    // Room for size slots, to be filled in place
+    span<S> extend(size_t size) {
+        size_t at = out.size();
+        out.resize(at + size);
+        return span<S>(out.data() + at, size);
+    }
+
+    size_t size() const {
+        return out.size();
+    }
+
+private:
+    vector<S>& out;
+};
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <vector>
+#include "SerialWriter.hpp"
+#include "SerialReader.hpp"
 
 using namespace std;
 
@@ -11,4 +13,31 @@ public:
     virtual ~Serializable() {}
     virtual vector<T> serialize() = 0;
     virtual void deserialize(const vector<T>& serialized, size_t& nxt) = 0;
+
+    // Streaming interface, implementations override these to write straight
+    // into a shared buffer. The defaults go through serialize()/deserialize().
+
+    // Expected number of slots written, 0 when unknown
+    virtual size_t size_hint() const {
+        return 0;
+    }
+
+    virtual void write(SerialWriter<T>& writer) {
+        vector<T> serialized = serialize();
+        writer.write(serialized);
+    }
+
+    virtual void read(SerialReader<T>& reader) {
+        size_t nxt = reader.position();
+        if (const vector<T>* source = reader.vector_source()) {
+            deserialize(*source, nxt);
+            reader.skip(nxt - reader.position());
+            return;
+        }
+        span<const T> rest = reader.rest(); // not a vector, deserialize() needs a copy
+        vector<T> serialized(rest.begin(), rest.end());
+        nxt = 0;
+        deserialize(serialized, nxt);
+        reader.skip(nxt);
+    }
 };
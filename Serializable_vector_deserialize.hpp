@@ -1,14 +1,31 @@
 #pragma once
 
 #include <vector>
+#include "SerialReader.hpp"
+#include "ERROR.hpp"
 
 using namespace std;
 
 template<typename T, typename S>
-void Serializable_vector_deserialize(T& v, vector<T>& vec, const vector<S>& serialized, size_t& nxt) {
-    size_t size = serialized[nxt++];
+void Serializable_vector_deserialize(T& v, vector<T>& vec, SerialReader<S>& reader) {
+    size_t size = reader.read();
+    vec.reserve(vec.size() + min(size, reader.remaining()));
     for (size_t n = 0; n < size; n++) {
-        v.deserialize(serialized, nxt);
+        if constexpr (requires { v.read(reader); }) v.read(reader);
+        else {
+            if (!reader.vector_source())
+                throw ERROR("Serializable_vector_deserialize() needs a vector source for deserialize()");
+            size_t nxt = reader.position();
+            v.deserialize(*reader.vector_source(), nxt);
+            reader.skip(nxt - reader.position());
+        }
         vec.push_back(v);
     }
 }
+
+template<typename T, typename S>
+void Serializable_vector_deserialize(T& v, vector<T>& vec, const vector<S>& serialized, size_t& nxt) {
+    SerialReader<S> reader(serialized, nxt);
+    Serializable_vector_deserialize(v, vec, reader);
+    nxt = reader.position();
+}
@@ -1,14 +1,32 @@
 #pragma once
 
 #include <vector>
-#include "vector_concat.hpp"
+#include "SerialWriter.hpp"
 
 using namespace std;
 
+// Count slot, then every element. Elements with write(SerialWriter&) are
+// written in place (after one reserve() when they give a size_hint()), the
+// others are appended from serialize(). Linear in the output size.
 template<typename S, typename T>
-void Serializable_vector_serialize(vector<S>& serialized, vector<T>& vec) {
-    serialized.push_back(vec.size());
-    for (T& v: vec)
-        serialized = vector_concat(serialized, v.serialize());
+void Serializable_vector_serialize(SerialWriter<S>& writer, vector<T>& vec) {
+    if constexpr (requires(const T& x) { x.size_hint(); }) {
+        size_t hint = 1;
+        for (const T& v: vec) hint += v.size_hint();
+        writer.reserve(hint);
+    }
+    writer.write(vec.size());
+    for (T& v: vec) {
+        if constexpr (requires(T& x) { x.write(writer); }) v.write(writer);
+        else {
+            vector<S> serialized = v.serialize();
+            writer.write(serialized);
+        }
+    }
 }
 
+template<typename S, typename T>
+void Serializable_vector_serialize(vector<S>& serialized, vector<T>& vec) {
+    SerialWriter<S> writer(serialized);
+    Serializable_vector_serialize(writer, vec);
+}
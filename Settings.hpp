@@ -7,6 +7,14 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <typeindex>
+#include <any>
+#include <optional>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <tuple>
 
 using namespace std;
 
@@ -18,65 +26,93 @@ public:
     Settings(JSON& conf, Arguments& args) : args(&args), conf(&conf) {}
     Settings(Arguments& args, JSON& conf) : args(&args), conf(&conf) {}
 
+    // Copies the layers, the caches start empty
+    Settings(const Settings& other) : args(other.args), conf(other.conf), exts(other.exts) {}
+
+    Settings& operator=(const Settings& other) {
+        args = other.args;
+        conf = other.conf;
+        exts = other.exts;
+        return *this;
+    }
+
     // Add a JSON extension
     void extends(JSON ext) {
-        exts.extends(ext);
+        exts.extends(move(ext));
     }
 
-    // Compute a hash of the settings
+    // Compute a hash of the settings, the layer dumps are only redone
+    // when a layer changed since the last call (see JSON::version())
     string hash() const {
-        return get_hash(
-            (!exts.empty() ? exts.dump() : "<noexts>") +
-            (conf ? conf->dump() : "<noconf>") +
-            (args ? implode(" ", args->getArgsCRef()) : "<noargs>")
-        );
+        lock_guard<mutex> lock(cache_mutex);
+        if (!hashed || *hashed != stamp()) {
+            if (!exts_dump || exts_dump->first != exts.version())
+                exts_dump = { exts.version(), !exts.empty() ? exts.dump() : "<noexts>" };
+            if (!conf_dump || conf_dump->first != (conf ? conf->version() : 0))
+                conf_dump = { conf ? conf->version() : 0, conf ? conf->dump() : "<noconf>" };
+            hash_value = get_hash(
+                exts_dump->second +
+                conf_dump->second +
+                (args ? implode(" ", args->getArgsCRef()) : "<noargs>")
+            );
+            hashed = stamp();
+        }
+        return hash_value;
+    }
+
+    // Nested configuration without copying it (extensions first, then conf),
+    // valid while the owning JSON is alive and not modified at that key
+    JSONView view(const string& key) const {
+        if (!exts.empty() && exts.has(key)) return exts.view(key);
+        if (conf && conf->has(key)) return conf->view(key);
+        throw ERROR("Settings is missing for '" + key + "'");
     }
 
     // Check if a key exists
     bool has(const string& key) {
-        if (args && args->has(key)) return true;
-        if (!exts.empty() && exts.has(key)) return true;
-        if (conf && conf->has(key)) return true;
-        return false;
+        return cached<bool>(&Cache::found, key, [&]() {
+            if (args && args->has(key)) return true;
+            if (!exts.empty() && exts.has(key)) return true;
+            if (conf && conf->has(key)) return true;
+            return false;
+        });
     }
 
     bool has(const pair<string, string>& keys) {
-        if (args && args->has(keys)) return true;
-        if (!exts.empty() && exts.has(keys.first)) return true;
-        if (conf && conf->has(keys.first)) return true;
-        return false;
+        return cached<bool>(&Cache::found_pairs, keys, [&]() {
+            if (args && args->has(keys)) return true;
+            if (!exts.empty() && exts.has(keys.first)) return true;
+            if (conf && conf->has(keys.first)) return true;
+            return false;
+        });
     }
 
+    // Lookups are resolved through the layers once per key and type, the
+    // result (or its absence) is cached until a layer changes
     template<typename T>
     T get(const string& key) {
-        if constexpr (!is_container<T>::value) if (args && args->has(key)) return args->get<T>(key);
-        if (!exts.empty() && exts.has(key)) return exts.get<T>(key);
-        if (conf && conf->has(key)) return conf->get<T>(key);
-        throw ERROR("Settings is missing for '" + key + "'");
+        optional<T> value = resolved<T>(key);
+        if (!value) throw ERROR("Settings is missing for '" + key + "'");
+        return move(*value);
     }
 
     template<typename T>
     T get(const string& key, const T defval) {
-        if constexpr (!is_container<T>::value) if (args && args->has(key)) return args->get<T>(key);
-        if (!exts.empty() && exts.has(key)) return exts.get<T>(key);
-        if (conf && conf->has(key)) return conf->get<T>(key);
-        return defval;
+        optional<T> value = resolved<T>(key);
+        return value ? move(*value) : defval;
     }
 
     template<typename T>
     T get(const pair<string, string>& keys) {
-        if constexpr (!is_container<T>::value) if (args && args->has(keys)) return args->getByKey<T>(keys);
-        if (!exts.empty() && exts.has(keys.first)) return exts.get<T>(keys.first);
-        if (conf && conf->has(keys.first)) return conf->get<T>(keys.first);
-        throw ERROR("Settings is missing for '" + keys.first + "' (or '" + keys.second + "')");
+        optional<T> value = resolved<T>(keys);
+        if (!value) throw ERROR("Settings is missing for '" + keys.first + "' (or '" + keys.second + "')");
+        return move(*value);
     }
 
     template<typename T>
     T get(const pair<string, string>& keys, const T defval) {
-        if constexpr (!is_container<T>::value) if (args && args->has(keys)) return args->getByKey<T>(keys);
-        if (!exts.empty() && exts.has(keys.first)) return exts.get<T>(keys.first);
-        if (conf && conf->has(keys.first)) return conf->get<T>(keys.first);
-        return defval;
+        optional<T> value = resolved<T>(keys);
+        return value ? move(*value) : defval;
     }
 
     Arguments* args = nullptr;
@@ -84,6 +120,107 @@ public:
     JSONExts exts;
 
 private:
+    // Layer identities and versions the caches were built from, args are
+    // not modified after parsing so their address is enough
+    using Stamp = tuple<const Arguments*, const JSON*, size_t, size_t>;
+
+    Stamp stamp() const {
+        return { args, conf, conf ? conf->version() : 0, exts.version() };
+    }
+
+    // Immutable lookup cache, readers load the current one without locking,
+    // a miss copies it with the new entry and publishes the copy (misses are
+    // rare, at most one per key and type until a layer changes)
+    struct Cache {
+        Stamp stamp;
+        unordered_map<string, unordered_map<type_index, any>> values;
+        map<pair<string, string>, unordered_map<type_index, any>> value_pairs;
+        unordered_map<string, bool> found;
+        map<pair<string, string>, bool> found_pairs;
+    };
+
+    // Called with cache_mutex held: the cache to extend, empty when a layer changed
+    shared_ptr<Cache> next() const {
+        shared_ptr<const Cache> current = cache.load();
+        Stamp now = stamp();
+        if (current->stamp != now) {
+            shared_ptr<Cache> fresh = make_shared<Cache>();
+            fresh->stamp = now;
+            return fresh;
+        }
+        return make_shared<Cache>(*current);
+    }
+
+    template<typename R, typename Member, typename K, typename F>
+    R cached(Member member, const K& key, F resolve) const {
+        shared_ptr<const Cache> current = cache.load();
+        if (current->stamp == stamp()) {
+            auto it = ((*current).*member).find(key);
+            if (it != ((*current).*member).end()) return it->second;
+        }
+        lock_guard<mutex> lock(cache_mutex);
+        shared_ptr<Cache> updated = next();
+        R value = ((*updated).*member).emplace(key, resolve()).first->second;
+        cache.store(move(updated));
+        return value;
+    }
+
+    // An empty any caches that the key is missing for this type
+    template<typename T, typename K>
+    optional<T> resolved(const K& key) const {
+        auto lookup = [&key](const Cache& from) -> const any* {
+            const auto& keys = [&]() -> const auto& {
+                if constexpr (is_same_v<K, string>) return from.values;
+                else return from.value_pairs;
+            }();
+            auto types = keys.find(key);
+            if (types == keys.end()) return nullptr;
+            auto it = types->second.find(typeid(T));
+            return it == types->second.end() ? nullptr : &it->second;
+        };
+        shared_ptr<const Cache> current = cache.load();
+        const any* value = current->stamp == stamp() ? lookup(*current) : nullptr;
+        if (!value) {
+            lock_guard<mutex> lock(cache_mutex);
+            shared_ptr<Cache> updated = next();
+            value = lookup(*updated);
+            if (!value) {
+                auto& types = [&]() -> auto& {
+                    if constexpr (is_same_v<K, string>) return updated->values[key];
+                    else return updated->value_pairs[key];
+                }();
+                value = &types.emplace(typeid(T), resolve<T>(key)).first->second;
+            }
+            cache.store(updated);
+            current = move(updated); // keeps *value alive
+        }
+        if (!value->has_value()) return nullopt;
+        return any_cast<const T&>(*value);
+    }
+
+    template<typename T>
+    any resolve(const string& key) const {
+        if constexpr (!is_container<T>::value) if (args && args->has(key)) return args->get<T>(key);
+        if (!exts.empty() && exts.has(key)) return exts.get<T>(key);
+        if (conf && conf->has(key)) return conf->get<T>(key);
+        return any();
+    }
+
+    template<typename T>
+    any resolve(const pair<string, string>& keys) const {
+        if constexpr (!is_container<T>::value) if (args && args->has(keys)) return args->getByKey<T>(keys);
+        if (!exts.empty() && exts.has(keys.first)) return exts.get<T>(keys.first);
+        if (conf && conf->has(keys.first)) return conf->get<T>(keys.first);
+        return any();
+    }
+
+    mutable mutex cache_mutex; // serializes cache updates and hash()
+    mutable atomic<shared_ptr<const Cache>> cache = make_shared<const Cache>();
+    mutable optional<Stamp> hashed;
+    mutable string hash_value;
+    mutable optional<pair<size_t, string>> exts_dump;
+    mutable optional<pair<size_t, string>> conf_dump;
+
     // Default case: assume types are not containers
     template<typename T>
     struct is_container : false_type {};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "Logger.hpp"
+#include "EWHAT.hpp"
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <queue>
+#include <condition_variable>
+
+using namespace std;
+
+// Formats each record once and fans it out to several loggers (sinks).
+// Every sink filters by its own level_output and is written by its own
+// thread from its own queue, so a slow sink never stalls the others.
+class TeeLogger: public Logger {
+public:
+    TeeLogger() {}
+    TeeLogger(const vector<Logger*>& sinks) { for (Logger* sink: sinks) add(sink); }
+
+    virtual ~TeeLogger() {
+        shutdown();
+        for (unique_ptr<Sink>& sink: sinks) {
+            {
+                lock_guard<mutex> lock(sink->mtx);
+                sink->stopping = true;
+            }
+            sink->cv.notify_all();
+            if (sink->worker.joinable()) sink->worker.join();
+        }
+    }
+
+    // Sinks should be added before logging starts, the sink list is not locked
+    void add(Logger* logger) {
+        unique_ptr<Sink>& sink = sinks.emplace_back(make_unique<Sink>(safe(logger, "TeeLogger sink")));
+        Sink* ptr = sink.get();
+        sink->worker = thread([ptr]() { work(*ptr); });
+    }
+
+    // Records a sink may have queued, while a stalled sink is that far behind
+    // new records for it are dropped and counted in suppressed().dropped (0 = no limit)
+    void set_capacity(size_t capacity) { this->capacity = capacity; }
+
+    LogSuppressed suppressed() override {
+        LogSuppressed result = Logger::suppressed();
+        for (unique_ptr<Sink>& sink: sinks) {
+            lock_guard<mutex> lock(sink->mtx);
+            result.dropped += sink->dropped;
+        }
+        return result;
+    }
+
+    // Blocks until every queued record is written by every sink
+    void flush() {
+        for (unique_ptr<Sink>& sink: sinks) {
+            unique_lock<mutex> lock(sink->mtx);
+            sink->cv.wait(lock, [&sink]() { return sink->records.empty() && !sink->busy; });
+        }
+    }
+
+protected:
+
+    void dispatch(LogLevel level, const string& output) override {
+        for (unique_ptr<Sink>& sink: sinks)
+            if (level <= sink->logger->level_output) enqueue(*sink, output);
+    }
+
+    void write(const string& output) override {
+        for (unique_ptr<Sink>& sink: sinks) enqueue(*sink, output);
+    }
+
+private:
+
+    struct Sink {
+        Sink(Logger* logger): logger(logger) {}
+        Logger* logger;
+        thread worker;
+        mutex mtx;
+        condition_variable cv;
+        queue<string> records;
+        size_t dropped = 0;
+        bool stopping = false;
+        bool busy = false;
+    };
+
+    void enqueue(Sink& sink, const string& output) {
+        {
+            lock_guard<mutex> lock(sink.mtx);
+            size_t limit = capacity;
+            if (limit && sink.records.size() >= limit) {
+                sink.dropped++;
+                return;
+            }
+            sink.records.push(output);
+        }
+        sink.cv.notify_all();
+    }
+
+    static void work(Sink& sink) {
+        while (true) {
+            queue<string> records;
+            {
+                unique_lock<mutex> lock(sink.mtx);
+                sink.cv.wait(lock, [&sink]() { return sink.stopping || !sink.records.empty(); });
+                if (sink.records.empty()) return;
+                swap(records, sink.records);
+                sink.busy = true;
+            }
+            while (!records.empty()) {
+                try {
+                    lock_guard<mutex> lock(sink.logger->mtx);
+                    sink.logger->write(records.front());
+                } catch (exception& e) {
+                    cerr << "TeeLogger sink failed" << EWHAT << endl;
+                }
+                records.pop();
+            }
+            {
+                lock_guard<mutex> lock(sink.mtx);
+                sink.busy = false;
+            }
+            sink.cv.notify_all();
+        }
+    }
+
+    vector<unique_ptr<Sink>> sinks;
+    atomic<size_t> capacity = 65536;
+};
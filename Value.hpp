@@ -17,11 +17,19 @@
 #include "str_serialize.hpp"
 #include "cast.hpp"
 #include "str_deserialize.hpp"
+#include "packed.hpp"
+#include "str_append_number.hpp"
 
 using namespace std;
 
+template<typename real> class ValuesBlockT;
+template<typename real> class ValuesT;
+
 template<typename real = float, typename S = uint32_t>
 class ValueT: public Serializable<S>, public Stringable, public Dumpable {
+    template<typename> friend class ValuesBlockT;
+    template<typename> friend class ValuesT;
+
     static_assert(
         is_floating_point<real>::value, 
         "ValueT<T> only supports floating-point types"
@@ -175,29 +183,48 @@ public:
     // Implements Serializable
 
     inline vector<S> serialize() override {
-        vector<S> serialized = str_serialize<S>(name);
-        serialized.push_back(cast<S>(value));
-        serialized.push_back(cast<S>(lower));
-        serialized.push_back(cast<S>(upper));
-        serialized.push_back(cast<S>(step));
-        serialized.push_back(constant);
-        serialized.push_back(rounded);
-        serialized.push_back(clips);
-        serialized.push_back(throws);
+        vector<S> serialized;
+        SerialWriter<S> writer(serialized);
+        writer.reserve(size_hint());
+        write(writer);
         return serialized;
     }
 
     inline void deserialize(const vector<S>& serialized, size_t& nxt) override {
-        try {  
-            name = str_deserialize<S>(serialized, nxt);
-            value = cast<real>(serialized[nxt++]);
-            lower = cast<real>(serialized[nxt++]);
-            upper = cast<real>(serialized[nxt++]);
-            step = cast<real>(serialized[nxt++]);
-            constant = serialized[nxt++];
-            rounded = serialized[nxt++];
-            clips = serialized[nxt++];
-            throws = serialized[nxt++];
+        SerialReader<S> reader(serialized, nxt);
+        read(reader);
+        nxt = reader.position();
+    }
+
+    inline size_t size_hint() const override {
+        return 4 + name.size() + 8;
+    }
+
+    inline void write(SerialWriter<S>& writer) override {
+        str_serialize(writer, name);
+        span<S> out = writer.extend(8);
+        out[0] = cast<S>(value);
+        out[1] = cast<S>(lower);
+        out[2] = cast<S>(upper);
+        out[3] = cast<S>(step);
+        out[4] = constant;
+        out[5] = rounded;
+        out[6] = clips;
+        out[7] = throws;
+    }
+
+    inline void read(SerialReader<S>& reader) override {
+        try {
+            name = str_deserialize(reader);
+            span<const S> in = reader.read(8);
+            value = cast<real>(in[0]);
+            lower = cast<real>(in[1]);
+            upper = cast<real>(in[2]);
+            step = cast<real>(in[3]);
+            constant = in[4];
+            rounded = in[5];
+            clips = in[6];
+            throws = in[7];
             if (!fix())
                 throw ERROR("Couldn't sanitize deserialized value");
         } catch (exception& e) {
@@ -205,24 +232,80 @@ public:
         }
     }
 
+    // Fixed layout binary record: uint32 name size, name, value, lower,
+    // upper and step as real, one byte of flags. Little-endian, byte packed.
+
+    inline size_t packedSize() const {
+        return sizeof(uint32_t) + name.size() + 4 * sizeof(real) + 1;
+    }
+
+    inline void pack(char*& p) const {
+        packed_write(p, name);
+        packed_write(p, value);
+        packed_write(p, lower);
+        packed_write(p, upper);
+        packed_write(p, step);
+        packed_write<uint8_t>(p, (constant ? 1 : 0) | (rounded ? 2 : 0) | (clips ? 4 : 0) | (throws ? 8 : 0));
+    }
+
+    inline void unpack(const char*& p, const char* end) {
+        try {
+            packed_read(p, end, name);
+            value = packed_read<real>(p, end);
+            lower = packed_read<real>(p, end);
+            upper = packed_read<real>(p, end);
+            step = packed_read<real>(p, end);
+            uint8_t flags = packed_read<uint8_t>(p, end);
+            constant = flags & 1;
+            rounded = flags & 2;
+            clips = flags & 4;
+            throws = flags & 8;
+            if (lower > upper)
+                throw ERROR(ERR_INVALID_BOUNDS);
+            if (!isnan(step) && step <= 0)
+                throw ERROR(ERR_INVALID_STEP);
+            if (!fix())
+                throw ERROR("Couldn't sanitize unpacked value");
+        } catch (exception& e) {
+            throw ERROR("ValueT unpack failed" + EWHAT);
+        }
+    }
+
     // Implements Stringable
 
     inline string toString() const override {
         return toString("=", "\n");
     }
     inline string toString(const string ksep, const string vsep) const {
-        vector<string> lines = {
-            "name" + ksep + name,
-            "value" + ksep + to_string(value),
-            "lower" + ksep + to_string(lower),
-            "upper" + ksep + to_string(upper),
-            "step" + ksep + to_string(step),
-            "constant" + ksep + to_string(constant),
-            "rounded" + ksep + to_string(rounded),
-            "clips" + ksep + to_string(clips),
-            "throws" + ksep + to_string(throws),
+        string output;
+        output.reserve(128 + name.size());
+        toString(output, ksep, vsep);
+        return output;
+    }
+
+    // Appends to output, lets a caller reuse one buffer for many values
+    inline void toString(string& output, const string& ksep, const string& vsep, bool withName = true) const {
+        if (withName) {
+            output += "name";
+            output += ksep;
+            output += name;
+        }
+        bool first = !withName;
+        auto field = [&](const char* key, auto number) {
+            if (!first) output += vsep;
+            first = false;
+            output += key;
+            output += ksep;
+            str_append_number(output, number);
         };
-        return implode(vsep, lines);
+        field("value", value);
+        field("lower", lower);
+        field("upper", upper);
+        field("step", step);
+        field("constant", constant);
+        field("rounded", rounded);
+        field("clips", clips);
+        field("throws", throws);
     }
 
     inline void fromString(const string& input) override {
@@ -265,14 +348,14 @@ public:
     // TODO: use getAsUMap() instead!!
     unordered_map<string, string> getAsUMapStr(bool withName = true) const {
         unordered_map<string, string> map = {
-            { "value", to_string(value) },
-            { "lower", to_string(lower) },
-            { "upper", to_string(upper) },
-            { "step", to_string(step) },
-            { "constant", to_string(constant) },
-            { "rounded", to_string(rounded) },
-            { "clips", to_string(clips) },
-            { "throws", to_string(throws) },
+            { "value", str_number(value) },
+            { "lower", str_number(lower) },
+            { "upper", str_number(upper) },
+            { "step", str_number(step) },
+            { "constant", str_number(constant) },
+            { "rounded", str_number(rounded) },
+            { "clips", str_number(clips) },
+            { "throws", str_number(throws) },
         };
         if (withName) map["name"] = name;
         return map;
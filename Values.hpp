@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 #include "Value.hpp"
+#include "ValuesBlock.hpp"
 #include "Loadable.hpp"
 #include "Saveable.hpp"
 #include "file_get_contents.hpp"
@@ -9,10 +10,11 @@
 #include "vector_load.hpp"
 #include "vector_save.hpp"
 #include "vector_concat.hpp"
+#include "MappedFile.hpp"
 #include "safe.hpp"
 #include "IniData.hpp"
 #include "Initializable.hpp"
-#include "VECTOR_WRAPPER.hpp"
+#include <unordered_map>
 
 template<typename real = float> // , typename S = uint32_t>
 class ValuesT: public Initializable {
@@ -21,7 +23,46 @@ public:
 
     virtual ~ValuesT() {}
 
-    VECTOR_WRAPPER(ValueT<real>, values)
+    // Stable name handle: names are interned to ids that are never reused, so a
+    // handle resolved once stays valid across adds, removes and reloads (as
+    // long as the name is there). Hot code resolves a name once:
+    //   Values::Handle h = values.handle("x");
+    //   values[h] = 1;
+    struct Handle {
+        uint32_t id;
+    };
+
+    // vector interface (VECTOR_WRAPPER), the name index follows the changes
+    typename vector<ValueT<real>>::iterator begin() { return values.begin(); }
+    typename vector<ValueT<real>>::iterator end() { return values.end(); }
+    typename vector<ValueT<real>>::const_iterator begin() const { return values.begin(); }
+    typename vector<ValueT<real>>::const_iterator end() const { return values.end(); }
+    void push_back(ValueT<real> value) {
+        values.push_back(move(value));
+        indexLast();
+    }
+    size_t size() const { return values.size(); }
+    void reserve(size_t n) { values.reserve(n); }
+    bool empty() const { return values.empty(); }
+    const ValueT<real>& operator[](size_t at) const { return values[at]; }
+    ValueT<real>& operator[](size_t at) { return values[at]; }
+    vector<ValueT<real>>& operator=(const vector<ValueT<real>>& values) {
+        this->values = values;
+        reindex();
+        return this->values;
+    }
+    void resize(size_t size) {
+        values.resize(size);
+        reindex();
+    }
+    void resize(size_t size, ValueT<real>& x) {
+        values.resize(size, x);
+        reindex();
+    }
+    void clear() {
+        values.clear();
+        reindex();
+    }
 
     void onLoad() override {
         LOG_DEBUG("ValuesT are loaded, converts..");
@@ -100,34 +141,35 @@ public:
     T add(const string& name, T value) {
         if (has(name))
             throw ERROR("Already has: " + EMPTY_OR(name));
-        Value v(name, (real)value);
-        values.push_back(v);
+        ValueT<real> v(name, (real)value);
+        push_back(v);
         return v.getValue();
     }
 
-    bool has(const string& name) {
-        size_t size = values.size();
-        for (size_t i = 0; i < size; i++)
-            if (values[i].getNameCRef() == name) return true;
-        return false;
+    bool has(const string& name) const {
+        return find(name) != npos;
     }
 
     template<typename T>
     T set(const string& name, T value) {
-        size_t size = values.size();
-        for (size_t i = 0; i < size; i++)
-            if (values[i].getNameCRef() == name) {
-                return values[i] = value;
-            }
-        throw ERROR("Not found: " + EMPTY_OR(name));
+        size_t i = find(name);
+        if (i == npos) throw ERROR("Not found: " + EMPTY_OR(name));
+        return values[i] = value;
     }
 
     template<typename T>
-    T get(const string& name) {
-        size_t size = values.size();
-        for (size_t i = 0; i < size; i++)
-            if (values[i].getNameCRef() == name) return values[i];
-        throw ERROR("Not found: " + EMPTY_OR(name));
+    T get(const string& name) const {
+        size_t i = find(name);
+        if (i == npos) throw ERROR("Not found: " + EMPTY_OR(name));
+        return values[i];
+    }
+
+    // Removes a value, handles of the other names stay valid
+    void remove(const string& name) {
+        size_t i = find(name);
+        if (i == npos) throw ERROR("Not found: " + EMPTY_OR(name));
+        values.erase(values.begin() + i);
+        reindex();
     }
     
     // ValueT<real>& operator[](size_t index) {
@@ -144,26 +186,73 @@ public:
     }
     
     const ValueT<real>& operator[](const string& name) const {
-        size_t i = getIndexByName(name);
+        size_t i = find(name);
+        if (i == npos) throw ERROR("Value not found");
         return values[i];
     }
     
     ValueT<real>& getValueByName(const string& name) {
-        for (ValueT<real>& value: values)
-            if (value.getNameCRef() == name) return value;
-        throw ERROR("Value not found");
+        size_t i = find(name);
+        if (i == npos) throw ERROR("Value not found");
+        return values[i];
     }
     
     size_t getIndexByName(const string& name, bool create = true) {
-        size_t size = values.size();
-        for (size_t i = 0; i < size; i++)
-            if (values[i].getNameCRef() == name) return i;
+        size_t i = find(name);
+        if (i != npos) return i;
         if (create) {
-            values.push_back(ValueT<real>(name, .0f));
+            push_back(ValueT<real>(name, .0f));
             return values.size() - 1;
         }
         throw ERROR("Value not found");
     }
+
+    // Handle based access, no name hashing or comparing
+
+    Handle handle(const string& name) const {
+        auto it = ids.find(name);
+        if (it == ids.end() || slots[it->second] == npos)
+            throw ERROR("Value not found: " + EMPTY_OR(name));
+        return { it->second };
+    }
+
+    bool has(Handle h) const {
+        return h.id < slots.size() && slots[h.id] != npos;
+    }
+
+    ValueT<real>& operator[](Handle h) {
+        return values[slot(h)];
+    }
+
+    const ValueT<real>& operator[](Handle h) const {
+        return values[slot(h)];
+    }
+
+    real get(Handle h) const {
+        return values[slot(h)];
+    }
+
+    real set(Handle h, real value) {
+        return values[slot(h)] = value;
+    }
+
+    // Position of a value, for views that keep the values in their own arrays
+    size_t indexOf(Handle h) const {
+        return slot(h);
+    }
+
+    size_t indexOf(const string& name) const {
+        size_t i = find(name);
+        if (i == npos) throw ERROR("Not found: " + EMPTY_OR(name));
+        return i;
+    }
+
+    // Rebuilds the name index, needed only when a name was changed through a
+    // ValueT reference (e.g. values[i] = other_named_value)
+    void reindex() {
+        fill(slots.begin(), slots.end(), npos);
+        for (size_t i = 0; i < values.size(); i++) index(i);
+    }
     
     vector<real> getVariables() const {
         vector<real> reals;
@@ -172,14 +261,35 @@ public:
         return reals;
     }
     
+    // The whole vector is fixed in one values_sanitize() pass, every value is
+    // assigned and all the out of bounds ones are reported together
     void setVariables(const vector<real>& variables) {
-        size_t activeIndex = 0;
-        size_t variablesSize = variables.size();
-        for (ValueT<real>& value: values)
-            if (!value.isConstant() && activeIndex < variablesSize)
-                value = variables[activeIndex++];
-        if (variablesSize != activeIndex)
-            throw ERROR("Values size mismatch, " + to_string(variablesSize) + " != " + to_string(activeIndex));
+        sanitizing.clear();
+        for (size_t i = 0; i < values.size(); i++)
+            if (!values[i].isConstant()) sanitizing.push_back(i);
+        size_t size = sanitizing.size();
+        if (variables.size() != size)
+            throw ERROR("Values size mismatch, " + to_string(variables.size()) + " != " + to_string(size));
+        sanitized = variables;
+        sanitize_lower.resize(size);
+        sanitize_upper.resize(size);
+        sanitize_step.resize(size);
+        sanitize_flags.resize(size);
+        for (size_t k = 0; k < size; k++) {
+            const ValueT<real>& value = values[sanitizing[k]];
+            sanitize_lower[k] = value.lower;
+            sanitize_upper[k] = value.upper;
+            sanitize_step[k] = value.step;
+            sanitize_flags[k] = (value.rounded ? VALUES_ROUNDED : 0) | (value.clips ? VALUES_CLIPS : 0) | (value.throws ? VALUES_THROWS : 0);
+        }
+        violations.clear();
+        values_sanitize(sanitized.data(), size, sanitize_lower.data(), sanitize_upper.data(), sanitize_step.data(), sanitize_flags.data(), &violations);
+        for (size_t k = 0; k < size; k++) values[sanitizing[k]].value = sanitized[k];
+        if (!violations.empty()) {
+            vector<string> bad;
+            for (size_t k: violations) bad.push_back(values[sanitizing[k]].getNameCRef());
+            throw ERROR(string(ValueT<real>::ERR_OUT_OF_BOUNDS) + ": " + implode(", ", bad));
+        }
     }
     
     vector<real> getLowerBounds() const {
@@ -196,6 +306,117 @@ public:
         return bounds;
     }
 
+    // Structure of arrays copy for optimizer inner loops, see ValuesBlockT
+    ValuesBlockT<real> getBlock() const {
+        ValuesBlockT<real> block;
+        for (const ValueT<real>& value: values) block.push_back(value);
+        return block;
+    }
+
+    void setBlock(const ValuesBlockT<real>& block) {
+        values.clear();
+        values.reserve(block.size());
+        for (size_t i = 0; i < block.size(); i++) values.push_back(block.get(i));
+        reindex();
+    }
+
+    // Packed binary format, a 16 byte header ("VALS", uint16 version, uint8
+    // sizeof(real), uint8 reserved, uint64 count) then one ValueT::pack()
+    // record per value. Written into a caller owned buffer of packedSize()
+    // bytes, no intermediate vectors.
+
+    size_t packedSize() const {
+        size_t size = PACKED_HEADER_SIZE;
+        for (const ValueT<real>& value: values) size += value.packedSize();
+        return size;
+    }
+
+    // Returns the number of bytes written
+    size_t pack(char* buffer, size_t capacity) const {
+        size_t size = packedSize();
+        if (capacity < size)
+            throw ERROR("Packed values buffer too small, " + to_string(capacity) + " < " + to_string(size));
+        char* p = buffer;
+        memcpy(p, PACKED_MAGIC, 4);
+        p += 4;
+        packed_write<uint16_t>(p, PACKED_VERSION);
+        packed_write<uint8_t>(p, sizeof(real));
+        packed_write<uint8_t>(p, 0);
+        packed_write<uint64_t>(p, values.size());
+        for (const ValueT<real>& value: values) value.pack(p);
+        return p - buffer;
+    }
+
+    vector<char> pack() const {
+        vector<char> buffer(packedSize());
+        pack(buffer.data(), buffer.size());
+        return buffer;
+    }
+
+    // Returns the number of bytes read
+    size_t unpack(const char* buffer, size_t size) {
+        const char* p = buffer;
+        const char* end = buffer + size;
+        packed_need(p, end, PACKED_HEADER_SIZE);
+        if (memcmp(p, PACKED_MAGIC, 4) != 0)
+            throw ERROR("Packed values: invalid header");
+        p += 4;
+        uint16_t version = packed_read<uint16_t>(p, end);
+        if (version != PACKED_VERSION)
+            throw ERROR("Packed values: unsupported version " + to_string(version));
+        uint8_t real_size = packed_read<uint8_t>(p, end);
+        if (real_size != sizeof(real))
+            throw ERROR("Packed values: real size mismatch, " + to_string(real_size) + " != " + to_string(sizeof(real)));
+        p++; // reserved
+        uint64_t count = packed_read<uint64_t>(p, end);
+        vector<ValueT<real>> unpacked; // values stay untouched when the data is invalid
+        unpacked.reserve(min<uint64_t>(count, (end - p) / (sizeof(uint32_t) + 4 * sizeof(real) + 1)));
+        for (uint64_t i = 0; i < count; i++) {
+            unpacked.emplace_back();
+            unpacked.back().unpack(p, end);
+        }
+        values.swap(unpacked);
+        reindex();
+        return p - buffer;
+    }
+
+    void unpack(const vector<char>& buffer) {
+        unpack(buffer.data(), buffer.size());
+    }
+
+    void savePacked(const string& filename) const {
+        MappedOutputFile file(filename, packedSize());
+        pack(file.data(), file.size());
+    }
+
+    void loadPacked(const string& filename) {
+        MappedFile file(filename, true);
+        unpack(file.data(), file.size());
+    }
+
+    // INI text straight from the values, one section per value in the
+    // layout convert() reads back, without building an IniData first
+    void getAsIniText(string& output) const {
+        for (const ValueT<real>& value: values) {
+            output += '[';
+            output += value.getNameCRef();
+            output += "]\n";
+            value.toString(output, "=", "\n", false); // the section is the name
+            output += "\n\n";
+        }
+    }
+
+    string getAsIniText() const {
+        string output;
+        output.reserve(values.size() * 128);
+        getAsIniText(output);
+        return output;
+    }
+
+    void saveIni(const string& filename) const {
+        file_put_contents(filename, getAsIniText(), false, true);
+    }
+
     IniData getAsIniData() const {
         IniData iniData;
         for (const ValueT<real>& value: values) {
@@ -221,7 +442,46 @@ public:
     }
 
 private:
+    static constexpr size_t npos = (size_t)-1;
+    static constexpr const char* PACKED_MAGIC = "VALS";
+    static constexpr uint16_t PACKED_VERSION = 1;
+    static constexpr size_t PACKED_HEADER_SIZE = 16;
+
     vector<ValueT<real>> values;
+    unordered_map<string, uint32_t> ids; // interned names
+    vector<size_t> slots;                // id -> index in values, npos when missing
+
+    // setVariables() buffers, kept to avoid allocating on every call
+    vector<size_t> sanitizing, violations;
+    vector<real> sanitized, sanitize_lower, sanitize_upper, sanitize_step;
+    vector<uint8_t> sanitize_flags;
+
+    size_t find(const string& name) const {
+        auto it = ids.find(name);
+        if (it == ids.end()) return npos;
+        size_t i = slots[it->second];
+        return i != npos && values[i].getNameCRef() == name ? i : npos;
+    }
+
+    size_t slot(Handle h) const {
+        if (!has(h)) throw ERROR("Value not found by handle: " + to_string(h.id));
+        return slots[h.id];
+    }
+
+    // The first value of a name is the one found, like the linear search did
+    void index(size_t i) {
+        const string& name = values[i].getNameCRef();
+        auto it = ids.find(name);
+        if (it == ids.end()) {
+            it = ids.emplace(name, (uint32_t)slots.size()).first;
+            slots.push_back(npos);
+        }
+        if (slots[it->second] == npos) slots[it->second] = i;
+    }
+
+    void indexLast() {
+        index(values.size() - 1);
+    }
 
     void convert() {
         static const string sectionKey = "name";
@@ -242,6 +502,7 @@ private:
             value.fromString(valueStr, ksep, vsep);
             values.push_back(value);
         }
+        reindex();
     }
 };
 
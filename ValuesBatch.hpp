@@ -0,0 +1,189 @@
+#pragma once
+
+#include "Values.hpp"
+#include "Stopper.hpp"
+#include "values_sanitize.hpp"
+#include "implode.hpp"
+#include <vector>
+#include <string>
+#include <span>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+using namespace std;
+
+// Read-only view of one candidate: the values of a ValuesT with the
+// candidate's (sanitized) variables in place of the current ones. Names
+// and handles are resolved through the ValuesT, the numbers live in the
+// evaluating thread's own array, nothing is cloned.
+template<typename real = float>
+class ValuesViewT {
+public:
+    ValuesViewT(const ValuesT<real>& values, span<const real> data): values(&values), data(data) {}
+
+    size_t size() const { return data.size(); }
+    real operator[](size_t at) const { return data[at]; }
+    real operator[](typename ValuesT<real>::Handle h) const { return data[values->indexOf(h)]; }
+    real get(const string& name) const { return data[values->indexOf(name)]; }
+    real get(typename ValuesT<real>::Handle h) const { return data[values->indexOf(h)]; }
+    span<const real> getValues() const { return data; }
+
+private:
+    const ValuesT<real>* values;
+    span<const real> data;
+};
+
+struct ValuesBatchResult {
+    size_t candidate = 0; // index in the population
+    double score = 0;
+    double ms = 0;        // objective time, measured with Stopper
+    string error = "";    // out of bounds or thrown by the objective, the score is not set
+};
+
+// Evaluates a population of candidate vectors (as getVariables() lays them
+// out) against an objective on a pool of threads. Bounds, steps and flags
+// are taken from the ValuesT once, every candidate is sanitized the same
+// way setVariables() does it, but into a per thread array, so the ValuesT
+// is never written and objectives run in parallel. Results come back in
+// population order whatever thread finished first. The ValuesT must
+// outlive the batch and keep its values while evaluating.
+//   ValuesBatch batch(values);
+//   vector<ValuesBatchResult> results = batch.evaluate(population, [](const ValuesView& v) {
+//       return cost(v.get("x"), v.get("y"));
+//   });
+template<typename real = float>
+class ValuesBatchT {
+public:
+    using Objective = function<double(const ValuesViewT<real>& view)>;
+
+    // threads: 0 = one per hardware thread
+    ValuesBatchT(const ValuesT<real>& values, size_t threads = 0): values(values) {
+        for (size_t i = 0; i < values.size(); i++) {
+            const ValueT<real>& value = values[i];
+            base.push_back(value.getValue());
+            if (value.isConstant()) continue;
+            active.push_back(i);
+            lower.push_back(value.getLower());
+            upper.push_back(value.getUpper());
+            step.push_back(value.getStep());
+            flags.push_back((value.isRounded() ? VALUES_ROUNDED : 0) | (value.isClips() ? VALUES_CLIPS : 0) | (value.isThrows() ? VALUES_THROWS : 0));
+        }
+        if (!threads) threads = max(1u, thread::hardware_concurrency());
+        scratches.resize(threads);
+        for (size_t k = 0; k < threads; k++)
+            workers.emplace_back([this, k]() { work(k); });
+    }
+
+    ValuesBatchT(const ValuesBatchT&) = delete;
+    ValuesBatchT& operator=(const ValuesBatchT&) = delete;
+
+    ~ValuesBatchT() {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (thread& worker: workers) worker.join();
+    }
+
+    size_t getThreads() const {
+        return workers.size();
+    }
+
+    vector<ValuesBatchResult> evaluate(const vector<vector<real>>& population, Objective objective) {
+        lock_guard<mutex> batch(evaluating); // one batch at a time
+        vector<ValuesBatchResult> results(population.size());
+        unique_lock<mutex> lock(mtx);
+        job = { &population, &objective, &results };
+        next = 0;
+        finished = 0;
+        generation++;
+        wake.notify_all();
+        done.wait(lock, [this]() { return finished == workers.size(); });
+        job = {};
+        return results;
+    }
+
+private:
+    struct Job {
+        const vector<vector<real>>* population = nullptr;
+        const Objective* objective = nullptr;
+        vector<ValuesBatchResult>* results = nullptr;
+    };
+
+    // Per thread buffers, reused for every candidate
+    struct Scratch {
+        vector<real> data, variables;
+        vector<size_t> violations;
+    };
+
+    void work(size_t k) {
+        size_t seen = 0;
+        while (true) {
+            Job current;
+            {
+                unique_lock<mutex> lock(mtx);
+                wake.wait(lock, [&]() { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                current = job;
+            }
+            for (size_t i = next++; i < current.population->size(); i = next++)
+                (*current.results)[i] = run(scratches[k], i, (*current.population)[i], *current.objective);
+            {
+                lock_guard<mutex> lock(mtx);
+                finished++;
+            }
+            done.notify_one();
+        }
+    }
+
+    ValuesBatchResult run(Scratch& scratch, size_t i, const vector<real>& candidate, const Objective& objective) const {
+        ValuesBatchResult result;
+        result.candidate = i;
+        try {
+            if (candidate.size() != active.size())
+                throw ERROR("Values size mismatch, " + to_string(candidate.size()) + " != " + to_string(active.size()));
+            scratch.variables = candidate;
+            scratch.violations.clear();
+            values_sanitize(scratch.variables.data(), active.size(), lower.data(), upper.data(), step.data(), flags.data(), &scratch.violations);
+            if (!scratch.violations.empty()) {
+                vector<string> bad;
+                for (size_t k: scratch.violations) bad.push_back(values[active[k]].getNameCRef());
+                throw ERROR("Out of bounds: " + implode(", ", bad));
+            }
+            scratch.data = base;
+            for (size_t k = 0; k < active.size(); k++) scratch.data[active[k]] = scratch.variables[k];
+            ValuesViewT<real> view(values, scratch.data);
+            Stopper stopper;
+            result.score = objective(view);
+            result.ms = stopper.stop();
+        } catch (exception& e) {
+            result.error = e.what();
+        } catch (...) { // would terminate the worker thread and leave evaluate() waiting
+            result.error = "unknown exception";
+        }
+        return result;
+    }
+
+    const ValuesT<real>& values;
+    vector<real> base; // current values, constants stay as they are
+    vector<size_t> active;
+    vector<real> lower, upper, step;
+    vector<uint8_t> flags;
+
+    vector<thread> workers;
+    vector<Scratch> scratches;
+    mutex evaluating, mtx;
+    condition_variable wake, done;
+    bool stopping = false;
+    size_t generation = 0, finished = 0;
+    atomic<size_t> next = 0;
+    Job job;
+};
+
+using ValuesView = ValuesViewT<float>;
+using ValuesBatch = ValuesBatchT<float>;
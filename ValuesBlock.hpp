@@ -0,0 +1,204 @@
+#pragma once
+
+#include "Value.hpp"
+#include "ERROR.hpp"
+#include "values_sanitize.hpp"
+#include "implode.hpp"
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdint>
+
+using namespace std;
+
+template<typename real> class ValuesBlockT;
+
+// Lightweight handle to one element of a ValuesBlockT, reads and writes go
+// straight to the block arrays with the same rules as ValueT
+template<typename real = float>
+class ValueRefT {
+public:
+    ValueRefT(ValuesBlockT<real>& block, size_t at): block(&block), at(at) {}
+
+    const string& getNameCRef() const { return block->names[at]; }
+    real getValue() const { return block->value[at]; }
+    operator real() const { return block->value[at]; }
+
+    ValueRefT& operator=(real other) {
+        block->assign(at, other);
+        return *this;
+    }
+
+    real getLower() const { return block->lower[at]; }
+    real getUpper() const { return block->upper[at]; }
+    real getStep() const { return block->step[at]; }
+    bool isConstant() const { return block->constant[at]; }
+    bool isDiscrete() const { return !isnan(block->step[at]) && block->step[at] > 0; }
+    bool isRounded() const { return block->rounded[at]; }
+    bool isClips() const { return block->clips[at]; }
+    bool isThrows() const { return block->throws[at]; }
+
+    void setLower(real lower) { block->lower[at] = lower; block->changed(at); }
+    void setUpper(real upper) { block->upper[at] = upper; block->changed(at); }
+    void setBounds(real lower, real upper) { block->lower[at] = lower; block->upper[at] = upper; block->changed(at); }
+    void setStep(real step) { block->step[at] = step; block->changed(at); }
+    void setConstant(bool constant) { block->constant[at] = constant; block->changed(at, false); }
+    void setRounded(bool rounded) { block->rounded[at] = rounded; block->changed(at, false); }
+    void setClips(bool clips) { block->clips[at] = clips; block->changed(at, false); }
+    void setThrows(bool throws) { block->throws[at] = throws; block->changed(at, false); }
+
+    // Same tolerance as the ValueT comparisons
+    bool operator==(real other) const { return abs(getValue() - other) <= numeric_limits<real>::epsilon(); }
+    bool operator!=(real other) const { return !(*this == other); }
+
+private:
+    ValuesBlockT<real>* block;
+    size_t at;
+};
+
+// Structure of arrays parameter store for optimizer inner loops: value, lower,
+// upper and step are contiguous, the indexes of the variables (non constant
+// values) and their rules are kept precomputed, and setVariables() fixes a
+// whole vector in one values_sanitize() pass instead of one ValueT at a time.
+// Nothing is allocated once the block is built.
+//   ValuesBlock block = values.getBlock();
+//   optimizer.run(block.getLowerBounds(), block.getUpperBounds(), [&](const vector<float>& x) {
+//       block.setVariables(x);
+//       ...
+//   });
+//   values.setBlock(block);
+template<typename real = float>
+class ValuesBlockT {
+    friend class ValueRefT<real>;
+public:
+    ValuesBlockT() {}
+
+    template<typename S>
+    void push_back(const ValueT<real, S>& v) {
+        names.push_back(v.getNameCRef());
+        value.push_back(v.getValue());
+        lower.push_back(v.getLower());
+        upper.push_back(v.getUpper());
+        step.push_back(v.getStep());
+        constant.push_back(v.isConstant());
+        rounded.push_back(v.isRounded());
+        clips.push_back(v.isClips());
+        throws.push_back(v.isThrows());
+        dirty = true;
+    }
+
+    size_t size() const { return value.size(); }
+    bool empty() const { return value.empty(); }
+
+    ValueRefT<real> operator[](size_t at) { return ValueRefT<real>(*this, at); }
+
+    // Copy of an element as a standalone ValueT
+    ValueT<real> get(size_t at) const {
+        return ValueT<real>(value[at], names[at], lower[at], upper[at], step[at], constant[at], rounded[at], clips[at], throws[at]);
+    }
+
+    const vector<real>& getValues() const { return value; }
+
+    // Number of variables (non constant values)
+    size_t getVariablesSize() const {
+        prepare();
+        return active.size();
+    }
+
+    const vector<real>& getLowerBounds() const {
+        prepare();
+        return active_lower;
+    }
+
+    const vector<real>& getUpperBounds() const {
+        prepare();
+        return active_upper;
+    }
+
+    void getVariables(vector<real>& variables) const {
+        prepare();
+        variables.resize(active.size());
+        for (size_t k = 0; k < active.size(); k++) variables[k] = value[active[k]];
+    }
+
+    vector<real> getVariables() const {
+        vector<real> variables;
+        getVariables(variables);
+        return variables;
+    }
+
+    void setVariables(const vector<real>& variables) {
+        setVariables(variables.data(), variables.size());
+    }
+
+    void setVariables(const real* variables, size_t size) {
+        prepare();
+        if (size != active.size())
+            throw ERROR("Values size mismatch, " + to_string(size) + " != " + to_string(active.size()));
+        scratch.assign(variables, variables + size);
+        real* v = scratch.data();
+        violations.clear();
+        values_sanitize(v, size, active_lower.data(), active_upper.data(), active_step.data(), active_flags.data(), &violations);
+        for (size_t k = 0; k < size; k++) value[active[k]] = v[k];
+        if (!violations.empty()) {
+            vector<string> bad;
+            for (size_t k: violations) bad.push_back(names[active[k]]);
+            throw ERROR(string(ValueT<real>::ERR_OUT_OF_BOUNDS) + ": " + implode(", ", bad));
+        }
+    }
+
+private:
+
+    // Single element, same steps as ValueT::fix()
+    void fix(size_t at) {
+        uint8_t flags = (rounded[at] ? VALUES_ROUNDED : 0) | (clips[at] ? VALUES_CLIPS : 0) | (throws[at] ? VALUES_THROWS : 0);
+        if (!values_sanitize_scalar(value[at], lower[at], upper[at], step[at], flags))
+            throw ERROR(ValueT<real>::ERR_OUT_OF_BOUNDS);
+    }
+
+    void assign(size_t at, real other) {
+        if (constant[at]) throw ERROR(ValueT<real>::ERR_ASSIGN_TO_CONSTANT);
+        value[at] = other;
+        fix(at);
+    }
+
+    void changed(size_t at, bool refix = true) {
+        dirty = true;
+        if (refix) fix(at);
+    }
+
+    // Rebuilds the variable index map and the per variable rule arrays
+    void prepare() const {
+        if (!dirty) return;
+        active.clear();
+        for (size_t i = 0; i < value.size(); i++)
+            if (!constant[i]) active.push_back(i);
+        size_t n = active.size();
+        active_lower.resize(n);
+        active_upper.resize(n);
+        active_step.resize(n);
+        active_flags.resize(n);
+        for (size_t k = 0; k < n; k++) {
+            size_t i = active[k];
+            active_lower[k] = lower[i];
+            active_upper[k] = upper[i];
+            active_step[k] = step[i];
+            active_flags[k] = (rounded[i] ? VALUES_ROUNDED : 0) | (clips[i] ? VALUES_CLIPS : 0) | (throws[i] ? VALUES_THROWS : 0);
+        }
+        dirty = false;
+    }
+
+    vector<string> names;
+    vector<real> value, lower, upper, step;
+    vector<uint8_t> constant, rounded, clips, throws;
+
+    mutable bool dirty = true;
+    mutable vector<size_t> active;
+    mutable vector<real> active_lower, active_upper, active_step;
+    mutable vector<uint8_t> active_flags; // ValuesSanitizeFlag bits
+    vector<real> scratch;
+    vector<size_t> violations;
+};
+
+using ValuesBlock = ValuesBlockT<float>;
+using ValueRef = ValueRefT<float>;
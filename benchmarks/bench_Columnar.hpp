@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../BENCH.hpp"
+#include "../Columnar.hpp"
+#include "../vector_load.hpp"
+#include "../vector_save.hpp"
+#include "../datetime_defs.hpp"
+#include <cmath>
+
+// 1M records, scanning one field: the whole record file against one column
+struct bench_Columnar_Tick {
+    time_ms time;
+    double price;
+    double size;
+    int64_t flags;
+};
+
+static const bool bench_Columnar_files = []() {
+    vector<bench_Columnar_Tick> ticks;
+    for (size_t i = 0; i < 1'000'000; i++)
+        ticks.push_back({ 1700000000000LL + (time_ms)i * 250, 100.0 + (double)(i % 50), 1.0, 0 });
+    vector_save(ticks, "/tmp/bench_Columnar_ticks.bin");
+    column_save("/tmp/bench_Columnar", "time", ticks, &bench_Columnar_Tick::time, COLUMN_DELTA_PACKED);
+    column_save("/tmp/bench_Columnar", "price", ticks, &bench_Columnar_Tick::price);
+    return true;
+}();
+
+BENCH(bench_Columnar_records_scan_price, 10) {
+    double sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        vector<bench_Columnar_Tick> ticks;
+        vector_load(ticks, "/tmp/bench_Columnar_ticks.bin");
+        for (const bench_Columnar_Tick& tick: ticks) sum += tick.price;
+    }
+    BENCH_KEEP(sum);
+}
+
+BENCH(bench_Columnar_column_scan_price, 10) {
+    double sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        ColumnReader<double> prices("/tmp/bench_Columnar", "price");
+        prices.scan(-INFINITY, INFINITY, [&](size_t, double price) { sum += price; });
+    }
+    BENCH_KEEP(sum);
+}
+
+BENCH(bench_Columnar_column_read_time_packed, 10) {
+    size_t size = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        ColumnReader<time_ms> times("/tmp/bench_Columnar", "time");
+        size += times.read(0, times.rows()).size();
+    }
+    BENCH_KEEP(size);
+}
+
+// one hour of a day long series, min/max skip all the other blocks
+BENCH(bench_Columnar_column_range_time, 1000) {
+    size_t found = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        ColumnReader<time_ms> times("/tmp/bench_Columnar", "time");
+        found += times.scan(1700000000000LL + 3600'000, 1700000000000LL + 7200'000, [](size_t, time_ms) {});
+    }
+    BENCH_KEEP(found);
+}
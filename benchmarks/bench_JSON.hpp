@@ -0,0 +1,144 @@
+#pragma once
+
+#include "../BENCH.hpp"
+#include "../JSON.hpp"
+
+string bench_JSON_config() {
+    string jstring = "{";
+    for (int i = 0; i < 20; i++)
+        jstring += string(i ? "," : "") + "\"field" + to_string(i) + "\": {\"value\": " + to_string(i) + ", \"name\": \"name" + to_string(i) + "\"}";
+    return jstring + "}";
+}
+
+// Reading 20 fields the way json_get_int() did: type check parse + value parse per field
+BENCH(bench_JSON_20_fields_parse_per_field, 100) {
+    string jstring = bench_JSON_config();
+    for (size_t i = 0; i < iterations; i++) {
+        int sum = 0;
+        for (int f = 0; f < 20; f++) {
+            nlohmann::json::json_pointer ptr = _json_selector(".field" + to_string(f) + ".value");
+            if (!nlohmann::json::parse(jstring).at(ptr).is_number_integer()) throw ERROR("Unexpected");
+            sum += nlohmann::json::parse(jstring).at(ptr).get<int>();
+        }
+        BENCH_KEEP(sum);
+    }
+}
+
+BENCH(bench_JSON_20_fields_json_get_int, 100) {
+    string jstring = bench_JSON_config();
+    for (size_t i = 0; i < iterations; i++) {
+        int sum = 0;
+        for (int f = 0; f < 20; f++)
+            sum += json_get_int(jstring, ".field" + to_string(f) + ".value");
+        BENCH_KEEP(sum);
+    }
+}
+
+BENCH(bench_JSON_20_fields_document, 100) {
+    string jstring = bench_JSON_config();
+    for (size_t i = 0; i < iterations; i++) {
+        JSONDocument doc(jstring);
+        int sum = 0;
+        for (int f = 0; f < 20; f++)
+            sum += doc.getInt(".field" + to_string(f) + ".value");
+        BENCH_KEEP(sum);
+    }
+}
+
+BENCH(bench_JSON_parse_config, 10'000) {
+    string jstring = bench_JSON_config();
+    for (size_t i = 0; i < iterations; i++) {
+        nlohmann::json j = nlohmann::json::parse(jstring);
+        BENCH_KEEP(j);
+    }
+}
+
+BENCH(bench_JSON_selector_cached, 1'000'000) {
+    string jselector = ".field1.items[3].value";
+    for (size_t i = 0; i < iterations; i++) {
+        const nlohmann::json::json_pointer& ptr = json_selector(jselector);
+        BENCH_KEEP(ptr);
+    }
+}
+
+BENCH(bench_JSON_selector_uncached, 1'000'000) {
+    string jselector = ".field1.items[3].value";
+    string pointer;
+    for (size_t i = 0; i < iterations; i++) {
+        json_selector_to_pointer(jselector, &pointer);
+        nlohmann::json::json_pointer ptr(pointer);
+        BENCH_KEEP(ptr);
+    }
+}
+
+// Config corpus: settings-style files, one with comments and trailing commas
+string bench_JSON_fix_corpus(bool commented) {
+    string jstring = commented ? "// generated settings\n{\n" : "{\n";
+    for (int i = 0; i < 200; i++) {
+        jstring += "    \"section" + to_string(i) + "\": {\n";
+        if (commented) jstring += "        /* section " + to_string(i) + " */\n";
+        jstring += "        \"url\": \"http://example.com/" + to_string(i) + "\",\n";
+        jstring += "        \"values\": [1, 2, 3" + string(commented ? ",]" : "]") + ",\n";
+        jstring += "        \"enabled\": true" + string(commented ? ", // on\n" : "\n");
+        jstring += string("    }") + (i < 199 || commented ? ",\n" : "\n");
+    }
+    return jstring + "}\n";
+}
+
+BENCH(bench_JSON_fix_clean, 1000) {
+    string jstring = bench_JSON_fix_corpus(false);
+    for (size_t i = 0; i < iterations; i++) {
+        string fixed = json_fix(jstring);
+        BENCH_KEEP(fixed);
+    }
+}
+
+BENCH(bench_JSON_fix_commented, 1000) {
+    string jstring = bench_JSON_fix_corpus(true);
+    for (size_t i = 0; i < iterations; i++) {
+        string fixed = json_fix(jstring);
+        BENCH_KEEP(fixed);
+    }
+}
+
+// Nothing to fix, the pre-check alone decides
+BENCH(bench_JSON_fix_precheck_only, 10'000) {
+    string jstring = bench_JSON_config();
+    for (size_t i = 0; i < iterations; i++) {
+        string fixed = json_fix(jstring);
+        BENCH_KEEP(fixed);
+    }
+}
+
+// Reading a nested section: owning subtree copy vs a view into the document
+BENCH(bench_JSON_nested_get_copy, 100'000) {
+    JSON json(bench_JSON_config());
+    for (size_t i = 0; i < iterations; i++) {
+        int value = json.get<JSON>(".field7").get<int>(".value");
+        BENCH_KEEP(value);
+    }
+}
+
+BENCH(bench_JSON_nested_view, 100'000) {
+    JSON json(bench_JSON_config());
+    for (size_t i = 0; i < iterations; i++) {
+        int value = json.view(".field7").get<int>(".value");
+        BENCH_KEEP(value);
+    }
+}
+
+BENCH(bench_JSON_get_json_copy, 10'000) {
+    JSON json(bench_JSON_config());
+    for (size_t i = 0; i < iterations; i++) {
+        size_t size = json.get_json().size();
+        BENCH_KEEP(size);
+    }
+}
+
+BENCH(bench_JSON_get_json_cref, 10'000) {
+    JSON json(bench_JSON_config());
+    for (size_t i = 0; i < iterations; i++) {
+        size_t size = json.get_json_cref().size();
+        BENCH_KEEP(size);
+    }
+}
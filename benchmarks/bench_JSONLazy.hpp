@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../BENCH.hpp"
+#include "../JSONLazy.hpp"
+#include "../file_exists.hpp"
+#include "../file_get_contents.hpp"
+
+// Service startup with a ~50MB config snapshot: load it, read a few settings.
+// The snapshot files are written once into /tmp and reused by later runs.
+#define BENCH_JSON_SNAPSHOT "/tmp/bench_JSON_snapshot"
+
+const bool bench_JSONLazy_snapshot = []() {
+    if (file_exists(BENCH_JSON_SNAPSHOT ".json") && file_exists(BENCH_JSON_SNAPSHOT ".cbor")) return true;
+    nlohmann::json j;
+    for (int i = 0; i < 120'000; i++)
+        j["service" + to_string(i)] = {
+            { "name", "service_" + to_string(i) },
+            { "enabled", i % 3 != 0 },
+            { "threshold", i * 0.125 },
+            { "tags", { "alpha", "beta", "gamma", i } },
+            { "limits", { { "min", i }, { "max", i * 10 }, { "burst", 100 } } },
+            { "description", "Generated configuration section number " + to_string(i) + " for the startup benchmark" },
+        };
+    file_put_contents(BENCH_JSON_SNAPSHOT ".json", j.dump(4), false, true);
+    json_save_cbor(BENCH_JSON_SNAPSHOT ".cbor", j);
+    return true;
+}();
+
+BENCH(bench_JSON_startup_text, 2) {
+    for (size_t i = 0; i < iterations; i++) {
+        JSON conf(file_get_contents(BENCH_JSON_SNAPSHOT ".json"));
+        int max = conf.get<int>(".service4242.limits.max") + conf.get<int>(".service99999.limits.min");
+        BENCH_KEEP(max);
+    }
+}
+
+BENCH(bench_JSON_startup_cbor, 2) {
+    for (size_t i = 0; i < iterations; i++) {
+        JSON conf = JSON::load_cbor(BENCH_JSON_SNAPSHOT ".cbor");
+        int max = conf.get<int>(".service4242.limits.max") + conf.get<int>(".service99999.limits.min");
+        BENCH_KEEP(max);
+    }
+}
+
+BENCH(bench_JSON_startup_cbor_lazy, 2) {
+    for (size_t i = 0; i < iterations; i++) {
+        JSONLazy conf(BENCH_JSON_SNAPSHOT ".cbor");
+        int max = conf.get<int>(".service4242.limits.max") + conf.get<int>(".service99999.limits.min");
+        BENCH_KEEP(max);
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "../BENCH.hpp"
+#include "../JSONStream.hpp"
+#include "../file_put_contents.hpp"
+
+// ~10MB JSONL file, written before main()
+const string bench_JSONStream_file = []() {
+    string filename = "/tmp/bench_JSONStream.jsonl";
+    string content;
+    for (int i = 0; i < 100'000; i++)
+        content += "{\"id\": " + to_string(i) + ", \"name\": \"value_" + to_string(i) + "\", \"x\": " + to_string(i * 0.001) + ", \"flags\": [true, false, null]}\n";
+    file_put_contents(filename, content);
+    return filename;
+}();
+
+BENCH(bench_JSONStream_jsonl_serial, 5) {
+    for (size_t i = 0; i < iterations; i++) {
+        size_t count = json_stream_file(bench_JSONStream_file, [](nlohmann::json&& record) { BENCH_KEEP(record); });
+        BENCH_KEEP(count);
+    }
+}
+
+BENCH(bench_JSONStream_jsonl_parallel, 5) {
+    for (size_t i = 0; i < iterations; i++) {
+        size_t count = jsonl_parse_parallel(bench_JSONStream_file, [](nlohmann::json&& record) { BENCH_KEEP(record); });
+        BENCH_KEEP(count);
+    }
+}
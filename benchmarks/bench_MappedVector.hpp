@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../BENCH.hpp"
+#include "../MappedVector.hpp"
+#include "../vector_load.hpp"
+#include "../vector_save.hpp"
+
+// 16M floats (64 MB) in both formats, the load is timed with one touch per page
+static const bool bench_MappedVector_files = []() {
+    vector<float> data(16 * 1024 * 1024);
+    for (size_t i = 0; i < data.size(); i++) data[i] = (float)i;
+    vector_save(data, "/tmp/bench_vector.bin");
+    vector_save_mapped(data, "/tmp/bench_vector.vec");
+    return true;
+}();
+
+BENCH(bench_vector_load_64mb, 5) {
+    float sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        vector<float> data;
+        vector_load(data, "/tmp/bench_vector.bin");
+        for (size_t at = 0; at < data.size(); at += 1024) sum += data[at];
+    }
+    BENCH_KEEP(sum);
+}
+
+BENCH(bench_MappedVector_64mb, 5) {
+    float sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        MappedVector<float> data("/tmp/bench_vector.vec");
+        for (size_t at = 0; at < data.size(); at += 1024) sum += data[at];
+    }
+    BENCH_KEEP(sum);
+}
+
+BENCH(bench_MappedVector_64mb_verify, 5) {
+    size_t ok = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        MappedVector<float> data("/tmp/bench_vector.vec", true, true);
+        ok += data.size();
+    }
+    BENCH_KEEP(ok);
+}
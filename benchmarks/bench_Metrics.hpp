@@ -0,0 +1,23 @@
+#pragma once
+
+#include "../BENCH.hpp"
+#include "../Metrics.hpp"
+
+BENCH(bench_Metrics_counter_add, 100'000'000) {
+    MetricsCounter& counter = metrics().counter("bench_counter");
+    for (size_t i = 0; i < iterations; i++) counter.add();
+    uint64_t value = counter.value();
+    BENCH_KEEP(value);
+}
+
+BENCH(bench_Metrics_histogram_record, 100'000'000) {
+    MetricsHistogram& histogram = metrics().histogram("bench_histogram");
+    for (size_t i = 0; i < iterations; i++) histogram.record(i & 0xFFFF);
+    uint64_t p99 = histogram.snapshot().percentile(0.99);
+    BENCH_KEEP(p99);
+}
+
+BENCH(bench_Metrics_timer, 10'000'000) {
+    MetricsHistogram& histogram = metrics().histogram("bench_timer");
+    for (size_t i = 0; i < iterations; i++) MetricsTimer timer(histogram);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../BENCH.hpp"
+#include "../Settings.hpp"
+
+// Three layers, the looked up keys live in the bottom one (conf)
+static JSON bench_Settings_conf(R"({"server": {"host": "localhost", "port": 8080}, "workers": 4, "debug": false})");
+
+static Settings bench_Settings_make() {
+    Settings settings(bench_Settings_conf);
+    settings.extends(JSON(R"({"cache": {"size": 1024}, "name": "first"})"));
+    settings.extends(JSON(R"({"log": {"level": "info"}, "name": "second"})"));
+    return settings;
+}
+
+BENCH(bench_Settings_get, 1'000'000) {
+    Settings settings = bench_Settings_make();
+    long sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        sum += settings.get<int>(".server.port");
+        sum += settings.get<int>(".workers");
+        sum += settings.get<int>(".timeout", 30);
+    }
+    BENCH_KEEP(sum);
+}
+
+BENCH(bench_Settings_hash, 100'000) {
+    Settings settings = bench_Settings_make();
+    size_t size = 0;
+    for (size_t i = 0; i < iterations; i++) size += settings.hash().size();
+    BENCH_KEEP(size);
+}
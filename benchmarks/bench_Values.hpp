@@ -0,0 +1,176 @@
+#pragma once
+
+#include "../BENCH.hpp"
+#include "../Values.hpp"
+#include "../Serializable_vector_serialize.hpp"
+#include "../Serializable_vector_deserialize.hpp"
+
+// 64 parameters, every 8th constant, a mix of clipped, discrete and rounded ones
+static Values bench_Values_make() {
+    Values values;
+    for (int i = 0; i < 64; i++)
+        values.push_back(Value(0.0f, "p" + to_string(i), -100.0f, 100.0f,
+            i % 4 == 1 ? 0.5f : NAN, i % 8 == 0, i % 4 == 2, true));
+    return values;
+}
+
+static const vector<float> bench_Values_x = []() {
+    vector<float> x;
+    for (int i = 0; i < 56; i++) x.push_back((float)((i * 37) % 300) - 150.0f);
+    return x;
+}();
+
+// One optimizer step: read the bounds, write a candidate back
+BENCH(bench_Values_step_aos, 200'000) {
+    Values values = bench_Values_make();
+    float sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        sum += values.getLowerBounds()[3] + values.getUpperBounds()[3];
+        values.setVariables(bench_Values_x);
+    }
+    BENCH_KEEP(sum);
+}
+
+BENCH(bench_Values_step_block, 200'000) {
+    ValuesBlock block = bench_Values_make().getBlock();
+    float sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        sum += block.getLowerBounds()[3] + block.getUpperBounds()[3];
+        block.setVariables(bench_Values_x);
+    }
+    BENCH_KEEP(sum);
+}
+
+static const vector<string> bench_Values_names = []() {
+    vector<string> names;
+    for (int i = 0; i < 5000; i++) names.push_back("parameter_" + to_string(i));
+    return names;
+}();
+
+BENCH(bench_Values_add_5000, 10) {
+    size_t size = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        Values values;
+        for (const string& name: bench_Values_names) values.add(name, 1.0f);
+        size += values.size();
+    }
+    BENCH_KEEP(size);
+}
+
+static Values bench_Values_named = []() {
+    Values values;
+    for (const string& name: bench_Values_names) values.add(name, 1.0f);
+    return values;
+}();
+
+BENCH(bench_Values_get_by_name, 1'000'000) {
+    float sum = 0;
+    for (size_t i = 0; i < iterations; i++)
+        sum += bench_Values_named.get<float>(bench_Values_names[(i * 7919) % 5000]);
+    BENCH_KEEP(sum);
+}
+
+static const vector<Values::Handle> bench_Values_handles = []() {
+    vector<Values::Handle> handles;
+    for (const string& name: bench_Values_names) handles.push_back(bench_Values_named.handle(name));
+    return handles;
+}();
+
+BENCH(bench_Values_get_by_handle, 10'000'000) {
+    float sum = 0;
+    for (size_t i = 0; i < iterations; i++)
+        sum += bench_Values_named.get(bench_Values_handles[(i * 7919) % 5000]);
+    BENCH_KEEP(sum);
+}
+
+// 1000 values: the uint32_t slot serialization (SerialWriter) against the packed format
+static vector<Value> bench_Values_list = []() {
+    vector<Value> list;
+    for (int i = 0; i < 1000; i++) list.push_back(Value((float)i, "parameter_" + to_string(i), 0.0f, 1000.0f));
+    return list;
+}();
+
+static Values bench_Values_set = []() {
+    Values values;
+    values = bench_Values_list;
+    return values;
+}();
+
+static const vector<uint32_t> bench_Values_serialized = []() {
+    vector<uint32_t> serialized;
+    Serializable_vector_serialize(serialized, bench_Values_list);
+    return serialized;
+}();
+
+static const vector<char> bench_Values_packed = bench_Values_set.pack();
+
+BENCH(bench_Values_serialize_1000, 1000) {
+    size_t size = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        vector<uint32_t> serialized;
+        Serializable_vector_serialize(serialized, bench_Values_list);
+        size += serialized.size();
+    }
+    BENCH_KEEP(size);
+}
+
+BENCH(bench_Values_pack_1000, 1000) {
+    static vector<char> buffer(bench_Values_set.packedSize());
+    size_t size = 0;
+    for (size_t i = 0; i < iterations; i++)
+        size += bench_Values_set.pack(buffer.data(), buffer.size());
+    BENCH_KEEP(size);
+}
+
+// Loading a set: decode, then fill the named values
+BENCH(bench_Values_deserialize_1000, 200) {
+    static Values values;
+    size_t size = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        vector<Value> list;
+        Value value;
+        size_t nxt = 0;
+        Serializable_vector_deserialize(value, list, bench_Values_serialized, nxt);
+        values = list;
+        size += values.size();
+    }
+    BENCH_KEEP(size);
+}
+
+BENCH(bench_Values_unpack_1000, 1000) {
+    static Values values;
+    size_t size = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        values.unpack(bench_Values_packed);
+        size += values.size();
+    }
+    BENCH_KEEP(size);
+}
+
+// Saving 5000 values into an INI file: IniData and IniFile::save() against
+// the direct writer
+BENCH(bench_Values_ini_via_IniData_5000, 20) {
+    size_t size = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        IniFile ini;
+        ini.setData(bench_Values_named.getAsIniData());
+        ini.save("/tmp/bench_Values.ini");
+        size += ini.sections().size();
+    }
+    BENCH_KEEP(size);
+}
+
+BENCH(bench_Values_ini_text_5000, 20) {
+    size_t size = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        bench_Values_named.saveIni("/tmp/bench_Values.ini");
+        size++;
+    }
+    BENCH_KEEP(size);
+}
+
+BENCH(bench_Values_toString, 100'000) {
+    size_t size = 0;
+    for (size_t i = 0; i < iterations; i++) size += bench_Values_named[i % 5000].toString().size();
+    BENCH_KEEP(size);
+}
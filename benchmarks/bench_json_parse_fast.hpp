@@ -0,0 +1,42 @@
+#pragma once
+
+#include "../BENCH.hpp"
+#include "../json_parse_fast.hpp"
+
+// Dataset-like document with comments and trailing commas, rows * ~130 bytes
+string bench_json_parse_fast_doc(int rows) {
+    string jstring = "// exported values\n{\n    \"rows\": [\n";
+    for (int i = 0; i < rows; i++)
+        jstring += "        {\"id\": " + to_string(i) + ", \"name\": \"value_" + to_string(i) + "\", "
+            "\"x\": " + to_string(i * 0.001) + ", \"flags\": [true, false, null,], /* row */ \"tag\": \"a\\tb\"},\n";
+    return jstring + "    ],\n}\n";
+}
+
+// Documents are built before main(), so generating them is not measured
+#define BENCH_JSON_PARSE_FAST(label, rows, count) \
+    const string bench_json_parse_fast_##label##_doc = bench_json_parse_fast_doc(rows); \
+    BENCH(bench_json_parse_fast_##label##_json_parse_default, count) { \
+        const string& jstring = bench_json_parse_fast_##label##_doc; \
+        for (size_t i = 0; i < iterations; i++) { \
+            nlohmann::json j = json_parse_default(jstring); \
+            BENCH_KEEP(j); \
+        } \
+    } \
+    BENCH(bench_json_parse_fast_##label##_json_parse_fast, count) { \
+        const string& jstring = bench_json_parse_fast_##label##_doc; \
+        for (size_t i = 0; i < iterations; i++) { \
+            nlohmann::json j = json_parse_fast(jstring); \
+            BENCH_KEEP(j); \
+        } \
+    } \
+    BENCH(bench_json_parse_fast_##label##_structural_index, count) { \
+        const string& jstring = bench_json_parse_fast_##label##_doc; \
+        for (size_t i = 0; i < iterations; i++) { \
+            JSONStructuralIndex index = json_structural_index(jstring.data(), jstring.size()); \
+            BENCH_KEEP(index); \
+        } \
+    }
+
+BENCH_JSON_PARSE_FAST(small, 8, 10'000)     // ~1KB
+BENCH_JSON_PARSE_FAST(medium, 800, 100)     // ~100KB
+BENCH_JSON_PARSE_FAST(large, 80'000, 5)     // ~10MB
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "../BENCH.hpp"
+#include "../JSON.hpp"
+
+// 2000 services, the update changes one port and inserts one array element
+static const pair<nlohmann::json, nlohmann::json> bench_json_patch_docs = []() {
+    nlohmann::json doc = nlohmann::json::object();
+    for (int i = 0; i < 2000; i++) {
+        nlohmann::json& service = doc["services"]["service" + to_string(i)];
+        service["host"] = "host" + to_string(i) + ".local";
+        service["port"] = 8000 + i;
+        service["tags"] = { "a", "b", "c", "d" };
+    }
+    doc["hosts"] = nlohmann::json::array();
+    for (int i = 0; i < 2000; i++) doc["hosts"].push_back("h" + to_string(i));
+    nlohmann::json target = doc;
+    target["services"]["service1000"]["port"] = 1;
+    target["hosts"].insert(target["hosts"].begin() + 10, "new");
+    return make_pair(doc, target);
+}();
+
+static const string bench_json_patch_text = bench_json_patch_docs.second.dump();
+
+BENCH(bench_json_patch_diff_nlohmann, 20) {
+    size_t ops = 0;
+    for (size_t i = 0; i < iterations; i++)
+        ops += nlohmann::json::diff(bench_json_patch_docs.first, bench_json_patch_docs.second).size();
+    BENCH_KEEP(ops);
+}
+
+BENCH(bench_json_patch_diff, 20) {
+    size_t ops = 0;
+    for (size_t i = 0; i < iterations; i++)
+        ops += json_diff(bench_json_patch_docs.first, bench_json_patch_docs.second).size();
+    BENCH_KEEP(ops);
+}
+
+// Whole document shipped and parsed again
+BENCH(bench_json_patch_reparse, 20) {
+    size_t size = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        JSON json(bench_json_patch_text);
+        size += json.get_json_cref().size();
+    }
+    BENCH_KEEP(size);
+}
+
+static const nlohmann::json bench_json_patch_ops = json_diff(bench_json_patch_docs.first, bench_json_patch_docs.second);
+static const nlohmann::json bench_json_patch_undo = json_diff(bench_json_patch_docs.second, bench_json_patch_docs.first);
+static JSON bench_json_patch_doc(bench_json_patch_docs.first);
+
+// Only the patch shipped and applied in place (forth and back)
+BENCH(bench_json_patch_apply, 20'000) {
+    size_t size = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        bench_json_patch_doc.patch(i % 2 ? bench_json_patch_undo : bench_json_patch_ops);
+        size += bench_json_patch_doc.get_json_cref().size();
+    }
+    BENCH_KEEP(size);
+}
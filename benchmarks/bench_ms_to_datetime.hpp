@@ -0,0 +1,35 @@
+#pragma once
+
+#include "../BENCH.hpp"
+#include "../ms_to_datetime.hpp"
+#include "../coarse_get_time_ms.hpp"
+
+BENCH(bench_ms_to_datetime_render, 1'000'000) {
+    time_ms ms = 1696516245123LL;
+    for (size_t i = 0; i < iterations; i++) {
+        string datetime = ms_to_datetime_render(ms + (time_ms)(i / 100));
+        BENCH_KEEP(datetime);
+    }
+}
+
+BENCH(bench_ms_to_datetime_cached, 1'000'000) {
+    time_ms ms = 1696516245123LL;
+    for (size_t i = 0; i < iterations; i++) {
+        string datetime = ms_to_datetime(ms + (time_ms)(i / 100));
+        BENCH_KEEP(datetime);
+    }
+}
+
+BENCH(bench_default_get_time_ms, 10'000'000) {
+    for (size_t i = 0; i < iterations; i++) {
+        time_ms ms = default_get_time_ms();
+        BENCH_KEEP(ms);
+    }
+}
+
+BENCH(bench_coarse_get_time_ms, 10'000'000) {
+    for (size_t i = 0; i < iterations; i++) {
+        time_ms ms = coarse_get_time_ms();
+        BENCH_KEEP(ms);
+    }
+}
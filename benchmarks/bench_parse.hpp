@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../BENCH.hpp"
+#include "../parse.hpp"
+#include <vector>
+#include <string>
+
+// 1M numbers as they come from INI files
+static const vector<string> bench_parse_ints = []() {
+    vector<string> strs;
+    for (int i = 0; i < 1'000'000; i++) strs.push_back(to_string((i * 7919LL) % 4'000'000'000 - 2'000'000'000));
+    return strs;
+}();
+
+static const vector<string> bench_parse_doubles = []() {
+    vector<string> strs;
+    for (int i = 0; i < 1'000'000; i++) strs.push_back(to_string(i * 0.37 - 1000.0));
+    return strs;
+}();
+
+BENCH(bench_parse_int_1m, 3) {
+    long long sum = 0;
+    for (size_t i = 0; i < iterations; i++)
+        for (const string& str: bench_parse_ints) sum += parse<int>(str);
+    BENCH_KEEP(sum);
+}
+
+BENCH(bench_parse_double_1m, 3) {
+    double sum = 0;
+    for (size_t i = 0; i < iterations; i++)
+        for (const string& str: bench_parse_doubles) sum += parse<double>(str);
+    BENCH_KEEP(sum);
+}
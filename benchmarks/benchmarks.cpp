@@ -0,0 +1,18 @@
+#include "../BENCH.hpp"
+
+#include "bench_Columnar.hpp"
+#include "bench_JSON.hpp"
+#include "bench_JSONLazy.hpp"
+#include "bench_JSONStream.hpp"
+#include "bench_json_parse_fast.hpp"
+#include "bench_json_patch.hpp"
+#include "bench_MappedVector.hpp"
+#include "bench_Metrics.hpp"
+#include "bench_ms_to_datetime.hpp"
+#include "bench_parse.hpp"
+#include "bench_Settings.hpp"
+#include "bench_Values.hpp"
+
+int main(int argc, char* argv[]) {
+    benchmarker.run(vector<string>(argv + 1, argv + argc));
+}
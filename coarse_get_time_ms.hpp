@@ -0,0 +1,39 @@
+#pragma once
+
+#include "datetime_defs.hpp"
+#include "default_get_time_ms.hpp"
+#include <atomic>
+#include <thread>
+
+using namespace std;
+
+// Clock that is read from memory, a background thread refreshes it every resolution ms
+class CoarseClock {
+public:
+    CoarseClock(time_ms resolution = 1): resolution(resolution) {}
+
+    ~CoarseClock() {
+        running = false;
+        if (ticker.joinable()) ticker.join();
+    }
+
+    time_ms get() const { return now.load(memory_order_relaxed); }
+
+private:
+    const time_ms resolution;
+    atomic<bool> running = true;
+    atomic<time_ms> now = default_get_time_ms();
+    thread ticker = thread([this]() {
+        while (running) {
+            this_thread::sleep_for(chrono::milliseconds(resolution));
+            now.store(default_get_time_ms(), memory_order_relaxed);
+        }
+    });
+};
+
+// Drop-in for the get_time_ms hook when ~1ms precision is enough:
+// get_time_ms = coarse_get_time_ms;
+time_ms coarse_get_time_ms() {
+    static CoarseClock clock;
+    return clock.get();
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <array>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CRC32C_X86
+#include <nmmintrin.h>
+#endif
+
+using namespace std;
+
+// Ways crc32c() can compute the checksum, both give the same result
+enum Crc32cKernel: uint8_t {
+    CRC32C_KERNEL_SOFTWARE = 0, // slicing by 8
+    CRC32C_KERNEL_SSE42,        // the crc32 instruction
+};
+
+inline uint32_t crc32c_software(const uint8_t* p, size_t size, uint32_t crc) {
+    static const auto table = []() {
+        array<array<uint32_t, 256>, 8> t;
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = c & 1 ? (c >> 1) ^ 0x82F63B78 : c >> 1;
+            t[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; i++)
+            for (int s = 1; s < 8; s++) t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+        return t;
+    }();
+    for (; size >= 8; size -= 8, p += 8) {
+        uint32_t lo = crc ^ (p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24);
+        crc = table[7][lo & 0xFF] ^ table[6][(lo >> 8) & 0xFF] ^ table[5][(lo >> 16) & 0xFF] ^ table[4][lo >> 24] ^
+              table[3][p[4]] ^ table[2][p[5]] ^ table[1][p[6]] ^ table[0][p[7]];
+    }
+    for (; size; size--) crc = (crc >> 8) ^ table[0][(crc ^ *p++) & 0xFF];
+    return crc;
+}
+
+#ifdef CRC32C_X86
+
+// Compiled for SSE4.2 whatever the build flags are, crc32c_kernel() checks
+// the CPU before it is called
+__attribute__((target("sse4.2")))
+inline uint32_t crc32c_sse42(const uint8_t* p, size_t size, uint32_t crc) {
+    uint64_t c = crc;
+    for (; size >= 8; size -= 8, p += 8) {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        c = _mm_crc32_u64(c, word);
+    }
+    crc = (uint32_t)c;
+    for (; size; size--) crc = _mm_crc32_u8(crc, *p++);
+    return crc;
+}
+
+#endif
+
+// The crc32 instruction when this CPU has it, checked once
+inline Crc32cKernel crc32c_kernel() {
+#ifdef CRC32C_X86
+    static const Crc32cKernel kernel = __builtin_cpu_supports("sse4.2") ? CRC32C_KERNEL_SSE42 : CRC32C_KERNEL_SOFTWARE;
+    return kernel;
+#else
+    return CRC32C_KERNEL_SOFTWARE;
+#endif
+}
+
+// CRC-32C (Castagnoli) with the given kernel, it has to be one the CPU
+// supports, see crc32c_kernel(). Pass the previous result as crc to continue
+// a checksum over appended data.
+inline uint32_t crc32c(const void* data, size_t size, uint32_t crc, Crc32cKernel kernel) {
+    const uint8_t* p = (const uint8_t*)data;
+#ifdef CRC32C_X86
+    if (kernel == CRC32C_KERNEL_SSE42) return ~crc32c_sse42(p, size, ~crc);
+#else
+    (void)kernel;
+#endif
+    return ~crc32c_software(p, size, ~crc);
+}
+
+inline uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0) {
+    return crc32c(data, size, crc, crc32c_kernel());
+}
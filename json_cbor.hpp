@@ -0,0 +1,232 @@
+#pragma once
+
+#include "../../libs/nlohmann/json/master/single_include/nlohmann/json.hpp"
+#include "ERROR.hpp"
+#include "MappedFile.hpp"
+#include "file_put_contents.hpp"
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+using namespace std;
+
+// Walks and decodes CBOR as written by nlohmann::json::to_cbor.
+// Strings are copied in one piece instead of byte by byte (which makes it
+// several times faster than from_cbor), and items can be skipped without
+// decoding them, used for lazy access (see JSONLazy).
+class CBORReader {
+public:
+    CBORReader(const uint8_t* begin, const uint8_t* end, const string& source = "CBOR data"):
+        begin(begin), end(end), source(source) {}
+
+    // Decodes the single item of the whole input
+    nlohmann::json decode() const {
+        nlohmann::json out;
+        const uint8_t* p = decode(begin, out);
+        if (p != end) fail("Unexpected data after the CBOR item");
+        return out;
+    }
+
+    // Decodes the item at p into out, returns the position after it
+    const uint8_t* decode(const uint8_t* p, nlohmann::json& out, int depth = 0) const {
+        if (depth > 10000) fail("CBOR nesting too deep");
+        uint64_t subtype = 0;
+        bool tagged = false;
+        while ((*check(p) >> 5) == 6) {
+            bool indefinite;
+            p = head(p, subtype, indefinite);
+            tagged = true;
+        }
+        uint8_t ib = *p;
+        uint8_t major = ib >> 5;
+        uint64_t arg;
+        bool indefinite;
+        p = head(p, arg, indefinite);
+        switch (major) {
+            case 0:
+                out = (uint64_t)arg;
+                return p;
+            case 1:
+                out = (int64_t)-1 - (int64_t)arg;
+                return p;
+            case 2: {
+                nlohmann::json::binary_t::container_type bytes;
+                p = chunks(p, arg, indefinite, 2, [&bytes](const uint8_t* data, size_t size) {
+                    bytes.insert(bytes.end(), data, data + size);
+                });
+                out = tagged ? nlohmann::json::binary(move(bytes), (uint8_t)subtype) : nlohmann::json::binary(move(bytes));
+                return p;
+            }
+            case 3: {
+                string text;
+                p = chunks(p, arg, indefinite, 3, [&text](const uint8_t* data, size_t size) {
+                    text.append((const char*)data, size);
+                });
+                out = move(text);
+                return p;
+            }
+            case 4: {
+                out = nlohmann::json::array();
+                nlohmann::json::array_t& items = *out.get_ptr<nlohmann::json::array_t*>();
+                if (!indefinite) items.reserve(min<uint64_t>(arg, end - p));
+                for (uint64_t i = 0; indefinite ? *check(p) != 0xFF : i < arg; i++) {
+                    items.emplace_back();
+                    p = decode(p, items.back(), depth + 1);
+                }
+                return indefinite ? p + 1 : p;
+            }
+            case 5: {
+                out = nlohmann::json::object();
+                nlohmann::json::object_t& members = *out.get_ptr<nlohmann::json::object_t*>();
+                for (uint64_t i = 0; indefinite ? *check(p) != 0xFF : i < arg; i++) {
+                    if ((*check(p) >> 5) != 3) fail("CBOR map key is not a string");
+                    uint64_t len;
+                    bool chunked;
+                    string key;
+                    p = head(p, len, chunked);
+                    p = chunks(p, len, chunked, 3, [&key](const uint8_t* data, size_t size) {
+                        key.append((const char*)data, size);
+                    });
+                    p = decode(p, members[move(key)], depth + 1);
+                }
+                return indefinite ? p + 1 : p;
+            }
+            default:
+                switch (ib & 31) {
+                    case 20: out = false; return p;
+                    case 21: out = true; return p;
+                    case 22: out = nullptr; return p;
+                    case 25: out = half((uint16_t)arg); return p;
+                    case 26: {
+                        uint32_t bits = (uint32_t)arg;
+                        float f;
+                        memcpy(&f, &bits, sizeof(f));
+                        out = (double)f;
+                        return p;
+                    }
+                    case 27: {
+                        double d;
+                        memcpy(&d, &arg, sizeof(d));
+                        out = d;
+                        return p;
+                    }
+                    default: fail("Unsupported CBOR simple value");
+                }
+        }
+    }
+
+    // Position after the item at p, nested items are skipped without decoding
+    const uint8_t* skip(const uint8_t* p) const {
+        p = tags(p);
+        uint8_t major = *p >> 5;
+        uint64_t arg;
+        bool indefinite;
+        p = head(p, arg, indefinite);
+        switch (major) {
+            case 2:
+            case 3:
+                return chunks(p, arg, indefinite, major, [](const uint8_t*, size_t) {});
+            case 4:
+            case 5: {
+                if (indefinite) {
+                    while (*check(p) != 0xFF) p = skip(p);
+                    return p + 1;
+                }
+                uint64_t items = major == 5 ? arg * 2 : arg;
+                for (uint64_t i = 0; i < items; i++) p = skip(p);
+                return p;
+            }
+            default: // integers, simple values and floats are all in the head
+                return p;
+        }
+    }
+
+    // Skips the tag heads in front of an item
+    const uint8_t* tags(const uint8_t* p) const {
+        while ((*check(p) >> 5) == 6) {
+            uint64_t arg;
+            bool indefinite;
+            p = head(p, arg, indefinite);
+        }
+        return p;
+    }
+
+    // Reads an item head, returns the position after it (the payload of strings)
+    const uint8_t* head(const uint8_t* p, uint64_t& arg, bool& indefinite) const {
+        uint8_t info = *check(p) & 31;
+        p++;
+        indefinite = info == 31;
+        if (info < 24 || indefinite) {
+            arg = info;
+            return p;
+        }
+        if (info > 27) fail("Invalid CBOR item");
+        size_t bytes = (size_t)1 << (info - 24);
+        if ((size_t)(end - p) < bytes) fail("Truncated CBOR data");
+        arg = 0;
+        for (size_t i = 0; i < bytes; i++) arg = (arg << 8) | p[i];
+        return p + bytes;
+    }
+
+    const uint8_t* check(const uint8_t* p) const {
+        if (p >= end) fail("Truncated CBOR data");
+        return p;
+    }
+
+    [[noreturn]] void fail(const string& msg) const {
+        throw ERROR(msg + " in: " + source);
+    }
+
+    const uint8_t* const begin;
+    const uint8_t* const end;
+
+private:
+
+    // Payload of a byte or text string (p is after the head), definite or chunked
+    template<typename F>
+    const uint8_t* chunks(const uint8_t* p, uint64_t len, bool indefinite, uint8_t major, F&& append) const {
+        if (!indefinite) {
+            if ((uint64_t)(end - p) < len) fail("Truncated CBOR data");
+            append(p, len);
+            return p + len;
+        }
+        while (*check(p) != 0xFF) {
+            if ((*p >> 5) != major) fail("Invalid CBOR string chunk");
+            bool nested;
+            p = head(p, len, nested);
+            if (nested || (uint64_t)(end - p) < len) fail("Invalid CBOR string chunk");
+            append(p, len);
+            p += len;
+        }
+        return p + 1;
+    }
+
+    // IEEE 754 half precision, as decoded by nlohmann
+    static double half(uint16_t h) {
+        unsigned exp = (h >> 10) & 0x1F, mant = h & 0x3FF;
+        double val = exp == 0 ? ldexp(mant, -24)
+            : exp != 31 ? ldexp(mant + 1024, (int)exp - 25)
+            : mant == 0 ? numeric_limits<double>::infinity() : numeric_limits<double>::quiet_NaN();
+        return (h & 0x8000) ? -val : val;
+    }
+
+    string source;
+};
+
+// Saves a document as CBOR, the file is replaced atomically (tmp file + rename)
+void json_save_cbor(const string& filename, const nlohmann::json& j) {
+    string bytes;
+    nlohmann::json::to_cbor(j, bytes);
+    string tmp = filename + ".tmp";
+    file_put_contents(tmp, bytes, false, true);
+    if (::rename(tmp.c_str(), filename.c_str()) != 0)
+        throw ERROR("Unable to rename CBOR file: " + tmp + " -> " + filename);
+}
+
+// Loads a CBOR document, decoded straight from the memory mapped file
+nlohmann::json json_load_cbor(const string& filename) {
+    MappedFile file(filename, true);
+    const uint8_t* data = (const uint8_t*)file.data();
+    return CBORReader(data, data + file.size(), filename).decode();
+}
@@ -0,0 +1,472 @@
+#pragma once
+
+#include "JSON.hpp"
+#include <charconv>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define JSON_INDEX_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// Two stage JSON parser for large documents.
+// Stage 1 classifies the input in 64 byte blocks (AVX2, SSE2 or scalar, picked at runtime) into bitmasks,
+// stage 2 walks the masks to skip whitespace and string contents in jumps and builds
+// the nlohmann::json DOM directly. Comments and trailing commas are accepted on the way,
+// so there is no json_fix / json_remove_comments pass.
+// Usage: json_parse = json_parse_fast; (every JSON(string) goes through it from then on)
+
+#define JSON_PARSE_FAST_MAX_DEPTH 1024
+
+// One bit per input byte, 64 bytes per mask word
+struct JSONStructuralIndex {
+    vector<uint64_t> nonws;    // not JSON whitespace
+    vector<uint64_t> special;  // '"', '\\' or a control character, string scanning stops at these
+    vector<uint64_t> nonascii; // high bit set, strings with these are UTF-8 validated
+};
+
+void json_index_block_scalar(const char* block, uint64_t& nonws, uint64_t& special, uint64_t& nonascii) {
+    nonws = special = nonascii = 0;
+    for (int i = 0; i < 64; i++) {
+        unsigned char c = block[i];
+        uint64_t bit = 1ULL << i;
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') nonws |= bit;
+        if (c == '"' || c == '\\' || c < 0x20) special |= bit;
+        if (c & 0x80) nonascii |= bit;
+    }
+}
+
+// Stage 1 kernels, the widest one the CPU supports is picked
+enum JSONIndexKernel: uint8_t {
+    JSON_INDEX_SCALAR = 0,
+    JSON_INDEX_SSE2,
+    JSON_INDEX_AVX2,
+};
+
+#ifdef JSON_INDEX_X86
+
+// The kernels are compiled for their instruction set whatever the build
+// flags are, json_index_kernel() checks the CPU before they are called
+
+__attribute__((target("avx2")))
+inline void json_index_blocks_avx2(const char* data, size_t blocks, uint64_t* nonws, uint64_t* special, uint64_t* nonascii) {
+    const __m256i space = _mm256_set1_epi8(' '), tab = _mm256_set1_epi8('\t'),
+        nl = _mm256_set1_epi8('\n'), cr = _mm256_set1_epi8('\r'),
+        quote = _mm256_set1_epi8('"'), backslash = _mm256_set1_epi8('\\'), ctrl = _mm256_set1_epi8(0x1F);
+    for (size_t b = 0; b < blocks; b++) {
+        const char* block = data + b * 64;
+        uint64_t ws = 0, sp = 0, hi = 0;
+        for (int i = 0; i < 2; i++) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(block + i * 32));
+            __m256i w = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, tab)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, nl), _mm256_cmpeq_epi8(v, cr))
+            );
+            __m256i s = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)),
+                _mm256_cmpeq_epi8(_mm256_max_epu8(v, ctrl), ctrl) // unsigned v <= 0x1F
+            );
+            ws |= (uint64_t)(uint32_t)_mm256_movemask_epi8(w) << (i * 32);
+            sp |= (uint64_t)(uint32_t)_mm256_movemask_epi8(s) << (i * 32);
+            hi |= (uint64_t)(uint32_t)_mm256_movemask_epi8(v) << (i * 32);
+        }
+        nonws[b] = ~ws;
+        special[b] = sp;
+        nonascii[b] = hi;
+    }
+}
+
+__attribute__((target("sse2")))
+inline void json_index_blocks_sse2(const char* data, size_t blocks, uint64_t* nonws, uint64_t* special, uint64_t* nonascii) {
+    const __m128i space = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t'),
+        nl = _mm_set1_epi8('\n'), cr = _mm_set1_epi8('\r'),
+        quote = _mm_set1_epi8('"'), backslash = _mm_set1_epi8('\\'), ctrl = _mm_set1_epi8(0x1F);
+    for (size_t b = 0; b < blocks; b++) {
+        const char* block = data + b * 64;
+        uint64_t ws = 0, sp = 0, hi = 0;
+        for (int i = 0; i < 4; i++) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(block + i * 16));
+            __m128i w = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+                _mm_or_si128(_mm_cmpeq_epi8(v, nl), _mm_cmpeq_epi8(v, cr))
+            );
+            __m128i s = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+                _mm_cmpeq_epi8(_mm_max_epu8(v, ctrl), ctrl) // unsigned v <= 0x1F
+            );
+            ws |= (uint64_t)(uint16_t)_mm_movemask_epi8(w) << (i * 16);
+            sp |= (uint64_t)(uint16_t)_mm_movemask_epi8(s) << (i * 16);
+            hi |= (uint64_t)(uint16_t)_mm_movemask_epi8(v) << (i * 16);
+        }
+        nonws[b] = ~ws;
+        special[b] = sp;
+        nonascii[b] = hi;
+    }
+}
+
+#endif
+
+// Widest kernel this CPU runs, checked once
+inline JSONIndexKernel json_index_kernel() {
+#ifdef JSON_INDEX_X86
+    static const JSONIndexKernel kernel =
+        __builtin_cpu_supports("avx2") ? JSON_INDEX_AVX2 :
+        __builtin_cpu_supports("sse2") ? JSON_INDEX_SSE2 : JSON_INDEX_SCALAR;
+    return kernel;
+#else
+    return JSON_INDEX_SCALAR;
+#endif
+}
+
+inline void json_index_blocks(JSONIndexKernel kernel, const char* data, size_t blocks, uint64_t* nonws, uint64_t* special, uint64_t* nonascii) {
+#ifdef JSON_INDEX_X86
+    if (kernel == JSON_INDEX_AVX2) return json_index_blocks_avx2(data, blocks, nonws, special, nonascii);
+    if (kernel == JSON_INDEX_SSE2) return json_index_blocks_sse2(data, blocks, nonws, special, nonascii);
+#else
+    (void)kernel;
+#endif
+    for (size_t b = 0; b < blocks; b++)
+        json_index_block_scalar(data + b * 64, nonws[b], special[b], nonascii[b]);
+}
+
+// Stage 1 with the given kernel (one the CPU supports, see json_index_kernel()),
+// the tail block is padded with spaces so it sets no bits past the end
+JSONStructuralIndex json_structural_index(const char* data, size_t size, JSONIndexKernel kernel) {
+    JSONStructuralIndex index;
+    size_t blocks = (size + 63) / 64;
+    index.nonws.resize(blocks);
+    index.special.resize(blocks);
+    index.nonascii.resize(blocks);
+    size_t full = size / 64;
+    json_index_blocks(kernel, data, full, index.nonws.data(), index.special.data(), index.nonascii.data());
+    if (full < blocks) {
+        char tail[64];
+        memset(tail, ' ', sizeof(tail));
+        memcpy(tail, data + full * 64, size - full * 64);
+        json_index_blocks(kernel, tail, 1, &index.nonws[full], &index.special[full], &index.nonascii[full]);
+    }
+    return index;
+}
+
+// Stage 1 with the widest kernel the CPU runs, simd = false forces the scalar one
+JSONStructuralIndex json_structural_index(const char* data, size_t size, bool simd = true) {
+    return json_structural_index(data, size, simd ? json_index_kernel() : JSON_INDEX_SCALAR);
+}
+
+// Stage 2
+class JSONFastParser {
+public:
+    JSONFastParser(const string& text, bool simd = true):
+        data(text.data()), size(text.size()), index(json_structural_index(data, size, simd)) {}
+
+    nlohmann::json parse() {
+        nlohmann::json result;
+        skip();
+        value(result, 0);
+        skip();
+        if (pos < size) fail("Unexpected trailing characters");
+        return result;
+    }
+
+private:
+
+    [[noreturn]] void fail(const string& msg) const {
+        throw ERROR("JSON parse error at byte " + to_string(pos) + ": " + msg);
+    }
+
+    // Position of the first set bit in [from, to), or to
+    size_t next(const vector<uint64_t>& masks, size_t from, size_t to) const {
+        if (from >= to) return to;
+        size_t block = from >> 6, last = (to - 1) >> 6;
+        uint64_t bits = masks[block] & (~0ULL << (from & 63));
+        while (!bits) {
+            if (++block > last) return to;
+            bits = masks[block];
+        }
+        size_t found = (block << 6) + __builtin_ctzll(bits);
+        return found < to ? found : to;
+    }
+
+    size_t next(const vector<uint64_t>& masks, size_t from) const {
+        return next(masks, from, size);
+    }
+
+    // Whitespace and comments
+    void skip() {
+        while (true) {
+            pos = next(index.nonws, pos);
+            if (pos + 1 >= size || data[pos] != '/') return;
+            if (data[pos + 1] == '/') {
+                const char* nl = (const char*)memchr(data + pos + 2, '\n', size - pos - 2);
+                pos = nl ? nl - data + 1 : size;
+            } else if (data[pos + 1] == '*') {
+                size_t end = string_view(data, size).find("*/", pos + 2);
+                if (end == string_view::npos) fail("Unterminated comment");
+                pos = end + 2;
+            } else return;
+        }
+    }
+
+    // A comma right before the closing bracket is dropped, the same as json_fix() does
+    bool closing(char closer) {
+        if (pos >= size) fail(string("Expected '") + closer + "'");
+        if (data[pos] == closer) {
+            pos++;
+            return true;
+        }
+        if (data[pos] != ',') return false;
+        size_t comma = pos++;
+        skip();
+        if (pos < size && data[pos] == closer) {
+            pos++;
+            return true;
+        }
+        pos = comma;
+        fail("Unexpected ','");
+    }
+
+    void value(nlohmann::json& out, int depth) {
+        if (pos >= size) fail("Unexpected end of input");
+        switch (data[pos]) {
+            case '{': object(out, depth); return;
+            case '[': array(out, depth); return;
+            case '"': {
+                string s;
+                str(s);
+                out = move(s);
+                return;
+            }
+            case 't': literal("true"); out = true; return;
+            case 'f': literal("false"); out = false; return;
+            case 'n': literal("null"); out = nullptr; return;
+            default: number(out);
+        }
+    }
+
+    void object(nlohmann::json& out, int depth) {
+        if (depth >= JSON_PARSE_FAST_MAX_DEPTH) fail("Nesting too deep");
+        out = nlohmann::json::object();
+        nlohmann::json::object_t& members = *out.get_ptr<nlohmann::json::object_t*>();
+        pos++;
+        skip();
+        if (closing('}')) return;
+        while (true) {
+            if (pos >= size || data[pos] != '"') fail("Expected a string key");
+            string key;
+            str(key);
+            skip();
+            if (pos >= size || data[pos] != ':') fail("Expected ':'");
+            pos++;
+            skip();
+            value(members[move(key)], depth + 1); // a repeated key overwrites, like nlohmann does
+            skip();
+            if (pos >= size) fail("Expected ',' or '}'");
+            if (data[pos] == '}') {
+                pos++;
+                return;
+            }
+            if (data[pos] != ',') fail("Expected ',' or '}'");
+            pos++;
+            skip();
+            if (pos < size && data[pos] == '}') {
+                pos++;
+                return;
+            }
+        }
+    }
+
+    void array(nlohmann::json& out, int depth) {
+        if (depth >= JSON_PARSE_FAST_MAX_DEPTH) fail("Nesting too deep");
+        out = nlohmann::json::array();
+        nlohmann::json::array_t& items = *out.get_ptr<nlohmann::json::array_t*>();
+        pos++;
+        skip();
+        if (closing(']')) return;
+        while (true) {
+            items.emplace_back();
+            value(items.back(), depth + 1);
+            skip();
+            if (pos >= size) fail("Expected ',' or ']'");
+            if (data[pos] == ']') {
+                pos++;
+                return;
+            }
+            if (data[pos] != ',') fail("Expected ',' or ']'");
+            pos++;
+            skip();
+            if (pos < size && data[pos] == ']') {
+                pos++;
+                return;
+            }
+        }
+    }
+
+    void literal(const char* word) {
+        size_t len = strlen(word);
+        if (size - pos < len || memcmp(data + pos, word, len) != 0) fail("Invalid literal");
+        pos += len;
+    }
+
+    void str(string& out) {
+        size_t start = ++pos;
+        while (true) {
+            size_t stop = next(index.special, pos);
+            if (stop >= size) fail("Unterminated string");
+            out.append(data + pos, stop - pos);
+            pos = stop;
+            char c = data[pos];
+            if (c == '"') break;
+            if (c != '\\') fail("Control character in string");
+            if (++pos >= size) fail("Unterminated string");
+            switch (data[pos++]) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': unicode(out); break;
+                default: pos--; fail("Invalid escape");
+            }
+        }
+        if (next(index.nonascii, start, pos) < pos && !utf8_valid(out)) fail("Invalid UTF-8 in string");
+        pos++;
+    }
+
+    unsigned hex4() {
+        if (size - pos < 4) fail("Invalid \\u escape");
+        unsigned cp = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = data[pos++];
+            cp <<= 4;
+            if (c >= '0' && c <= '9') cp |= c - '0';
+            else if (c >= 'a' && c <= 'f') cp |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') cp |= c - 'A' + 10;
+            else fail("Invalid \\u escape");
+        }
+        return cp;
+    }
+
+    void unicode(string& out) {
+        unsigned cp = hex4();
+        if (cp >= 0xDC00 && cp <= 0xDFFF) fail("Unpaired surrogate");
+        if (cp >= 0xD800 && cp <= 0xDBFF) {
+            if (size - pos < 2 || data[pos] != '\\' || data[pos + 1] != 'u') fail("Unpaired surrogate");
+            pos += 2;
+            unsigned low = hex4();
+            if (low < 0xDC00 || low > 0xDFFF) fail("Unpaired surrogate");
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+        }
+        if (cp < 0x80) out += (char)cp;
+        else if (cp < 0x800) {
+            out += (char)(0xC0 | (cp >> 6));
+            out += (char)(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += (char)(0xE0 | (cp >> 12));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        } else {
+            out += (char)(0xF0 | (cp >> 18));
+            out += (char)(0x80 | ((cp >> 12) & 0x3F));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        }
+    }
+
+    static bool utf8_valid(const string& s) {
+        size_t i = 0, n = s.size();
+        while (i < n) {
+            unsigned char c = s[i];
+            if (c < 0x80) {
+                i++;
+                continue;
+            }
+            size_t len;
+            unsigned cp;
+            if (c >= 0xC2 && c <= 0xDF) { len = 2; cp = c & 0x1F; }
+            else if (c >= 0xE0 && c <= 0xEF) { len = 3; cp = c & 0x0F; }
+            else if (c >= 0xF0 && c <= 0xF4) { len = 4; cp = c & 0x07; }
+            else return false;
+            if (n - i < len) return false;
+            for (size_t k = 1; k < len; k++) {
+                unsigned char cc = s[i + k];
+                if ((cc & 0xC0) != 0x80) return false;
+                cp = (cp << 6) | (cc & 0x3F);
+            }
+            if ((len == 3 && (cp < 0x800 || (cp >= 0xD800 && cp <= 0xDFFF))) ||
+                (len == 4 && (cp < 0x10000 || cp > 0x10FFFF))) return false;
+            i += len;
+        }
+        return true;
+    }
+
+    static bool digit(char c) { return c >= '0' && c <= '9'; }
+
+    void digits() {
+        if (pos >= size || !digit(data[pos])) fail("Invalid number");
+        while (pos < size && digit(data[pos])) pos++;
+    }
+
+    // Same number types as nlohmann: unsigned, negative integer, or double when it has
+    // a fraction / exponent or does not fit 64 bits
+    void number(nlohmann::json& out) {
+        size_t start = pos;
+        bool negative = data[pos] == '-', real = false;
+        if (negative) pos++;
+        if (pos < size && data[pos] == '0') pos++;
+        else digits();
+        if (pos < size && data[pos] == '.') {
+            real = true;
+            pos++;
+            digits();
+        }
+        if (pos < size && (data[pos] == 'e' || data[pos] == 'E')) {
+            real = true;
+            pos++;
+            if (pos < size && (data[pos] == '+' || data[pos] == '-')) pos++;
+            digits();
+        }
+        const char* first = data + start;
+        const char* last = data + pos;
+        if (!real) {
+            if (negative) {
+                int64_t i;
+                if (from_chars(first, last, i).ec == errc()) {
+                    out = i;
+                    return;
+                }
+            } else {
+                uint64_t u;
+                if (from_chars(first, last, u).ec == errc()) {
+                    out = u;
+                    return;
+                }
+            }
+        }
+        double d;
+        if (from_chars(first, last, d).ec != errc()) {
+            // under/overflow, strtod rounds the underflow to zero like nlohmann
+            d = strtod(string(first, last).c_str(), nullptr);
+            if (isinf(d)) {
+                pos = start;
+                fail("Number out of range");
+            }
+        }
+        out = d;
+    }
+
+    const char* data;
+    size_t size;
+    JSONStructuralIndex index;
+    size_t pos = 0;
+};
+
+nlohmann::json json_parse_fast(const string& jstring) {
+    return JSONFastParser(jstring).parse();
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "../../libs/nlohmann/json/master/single_include/nlohmann/json.hpp"
+#include <string>
+
+using namespace std;
+
+// JSON pointer token of an object key
+void json_pointer_append(string& path, const string& key) {
+    path += '/';
+    for (char c: key) {
+        if (c == '~') path += "~0";
+        else if (c == '/') path += "~1";
+        else path += c;
+    }
+}
+
+// RFC 6902 operations turning source into target, appended to ops.
+// Unlike nlohmann::json::diff() equal subtrees are not compared once per
+// nesting level, and arrays are matched on their common head and tail so an
+// element inserted or removed in the middle is one operation, not a replace
+// of every element after it.
+void json_diff(const nlohmann::json& source, const nlohmann::json& target, string& path, nlohmann::json& ops) {
+    auto op = [&](const char* name, const string& at, const nlohmann::json* value) {
+        nlohmann::json o = nlohmann::json::object();
+        o["op"] = name;
+        o["path"] = at;
+        if (value) o["value"] = *value;
+        ops.push_back(move(o));
+    };
+    if (source.is_object() && target.is_object()) {
+        size_t size = path.size();
+        for (auto it = source.cbegin(); it != source.cend(); ++it) {
+            json_pointer_append(path, it.key());
+            auto found = target.find(it.key());
+            if (found == target.end()) op("remove", path, nullptr);
+            else json_diff(it.value(), *found, path, ops);
+            path.resize(size);
+        }
+        for (auto it = target.cbegin(); it != target.cend(); ++it) {
+            if (source.contains(it.key())) continue;
+            json_pointer_append(path, it.key());
+            op("add", path, &it.value());
+            path.resize(size);
+        }
+    } else if (source.is_array() && target.is_array()) {
+        size_t ns = source.size(), nt = target.size();
+        size_t head = 0;
+        while (head < ns && head < nt && source[head] == target[head]) head++;
+        size_t tail = 0;
+        while (tail < ns - head && tail < nt - head && source[ns - 1 - tail] == target[nt - 1 - tail]) tail++;
+        size_t ls = ns - head - tail, lt = nt - head - tail, common = min(ls, lt);
+        size_t size = path.size();
+        for (size_t i = head; i < head + common; i++) {
+            path += '/' + to_string(i);
+            json_diff(source[i], target[i], path, ops);
+            path.resize(size);
+        }
+        for (size_t i = head + ls; i-- > head + common;) { // from the back, the indexes stay valid
+            path += '/' + to_string(i);
+            op("remove", path, nullptr);
+            path.resize(size);
+        }
+        for (size_t i = head + common; i < head + lt; i++) {
+            path += '/' + to_string(i);
+            op("add", path, &target[i]);
+            path.resize(size);
+        }
+    } else if (source != target) op("replace", path, &target);
+}
+
+nlohmann::json json_diff(const nlohmann::json& source, const nlohmann::json& target) {
+    nlohmann::json ops = nlohmann::json::array();
+    string path;
+    json_diff(source, target, path, ops);
+    return ops;
+}
@@ -6,7 +6,8 @@
 
 using namespace std;
 
-string ms_to_datetime(time_ms ms = get_time_ms(), const char* fmt = "%Y-%m-%d %H:%M:%S", bool millis = true, bool local = false) {
+// Renders the datetime with gmtime_r/localtime_r and put_time on every call
+string ms_to_datetime_render(time_ms ms, const char* fmt = "%Y-%m-%d %H:%M:%S", bool millis = true, bool local = false) {
     long sec = (signed)(ms / second_ms);
     long mil = (signed)(ms % second_ms);
 
@@ -22,3 +23,34 @@ string ms_to_datetime(time_ms ms = get_time_ms(), const char* fmt = "%Y-%m-%d %H
     return oss.str();
 }
 
+// Same as ms_to_datetime_render() but the seconds part is cached per thread
+// and rendered again only when the second, the format or the timezone flag changes
+string ms_to_datetime(time_ms ms = get_time_ms(), const char* fmt = "%Y-%m-%d %H:%M:%S", bool millis = true, bool local = false) {
+    if (ms < 0) return ms_to_datetime_render(ms, fmt, millis, local);
+
+    static thread_local struct {
+        time_ms sec = -1;
+        string fmt;
+        bool local = false;
+        string prefix;
+    } cache;
+
+    time_ms sec = ms / second_ms;
+    if (sec != cache.sec || local != cache.local || cache.fmt != fmt) {
+        cache.prefix = ms_to_datetime_render(sec * second_ms, fmt, false, local);
+        cache.sec = sec;
+        cache.fmt = fmt;
+        cache.local = local;
+    }
+    if (!millis) return cache.prefix;
+
+    int mil = (int)(ms % second_ms);
+    string result;
+    result.reserve(cache.prefix.size() + 4);
+    result += cache.prefix;
+    result += '.';
+    result += (char)('0' + mil / 100);
+    result += (char)('0' + mil / 10 % 10);
+    result += (char)('0' + mil % 10);
+    return result;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ERROR.hpp"
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <bit>
+#include <algorithm>
+#include <type_traits>
+
+using namespace std;
+
+// Byte packed little-endian fields, read and written with memcpy at any
+// alignment. Used by the fixed layout binary formats (see ValuesT::pack).
+
+template<typename T>
+inline void packed_write(char*& p, T value) {
+    static_assert(is_trivially_copyable_v<T>, "packed_write() needs a trivially copyable type");
+    memcpy(p, &value, sizeof(T));
+    if constexpr (endian::native == endian::big) reverse(p, p + sizeof(T));
+    p += sizeof(T);
+}
+
+inline void packed_write(char*& p, const string& str) {
+    packed_write<uint32_t>(p, (uint32_t)str.size());
+    memcpy(p, str.data(), str.size());
+    p += str.size();
+}
+
+inline void packed_need(const char* p, const char* end, size_t size) {
+    if ((size_t)(end - p) < size) throw ERROR("Packed data is truncated");
+}
+
+template<typename T>
+inline T packed_read(const char*& p, const char* end) {
+    static_assert(is_trivially_copyable_v<T>, "packed_read() needs a trivially copyable type");
+    packed_need(p, end, sizeof(T));
+    T value;
+    if constexpr (endian::native == endian::big) {
+        char bytes[sizeof(T)];
+        reverse_copy(p, p + sizeof(T), bytes);
+        memcpy(&value, bytes, sizeof(T));
+    } else memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return value;
+}
+
+inline void packed_read(const char*& p, const char* end, string& str) {
+    uint32_t size = packed_read<uint32_t>(p, end);
+    packed_need(p, end, size);
+    str.assign(p, size);
+    p += size;
+}
@@ -1,45 +1,54 @@
 #pragma once
 
-#include "in_array.hpp"
 #include <algorithm>
+#include <charconv>
+#include <string>
+#include <string_view>
 #include "EMPTY_OR.hpp"
 #include "ERROR.hpp"
-#include <vector>
 
 using namespace std;
 
+// Parses a whole string into T with from_chars, no streams and no copies.
+// Surrounding whitespace and a leading '+' are accepted, anything else left
+// over is an error. Floating points also take inf, +inf, -inf and nan (any
+// case), booleans true/on/1/yes and false/off/0/no (any case).
 template <typename T>
-T parse(const string& str) {
+T parse(string_view str) {
     if constexpr (is_same_v<T, string>) {
-        return str; // Return the string directly
+        return string(str); // Return the string directly
+    } else if constexpr (is_same_v<T, bool>) {
+        auto is = [&str](string_view word) {
+            return str.size() == word.size() && equal(str.begin(), str.end(), word.begin(), [](char c, char w) {
+                return (char)tolower((unsigned char)c) == w;
+            });
+        };
+        if (is("true") || is("on") || is("1") || is("yes")) return true;
+        if (is("false") || is("off") || is("0") || is("no")) return false;
+        throw ERROR("Invalid input string (not a boolean): " + EMPTY_OR(string(str)));
     } else {
         static_assert(is_arithmetic<T>::value, "T must be an arithmetic type");
-        stringstream ss(str);
+        const char* spaces = " \t\n\r\f\v";
+        string_view number = str;
+        number.remove_prefix(min(number.find_first_not_of(spaces), number.size()));
+        number.remove_suffix(number.size() - (number.find_last_not_of(spaces) + 1));
+        if (number.size() > 1 && number[0] == '+' && number[1] != '-' && number[1] != '+')
+            number.remove_prefix(1);
         T num;
-        
-        // Handle special floating-point values for float and double
-        if constexpr (is_floating_point_v<T>) {
-            string lower = str;
-            transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-            if (lower == "inf" || lower == "+inf") return numeric_limits<T>::infinity();
-            if (lower == "-inf") return -numeric_limits<T>::infinity();
-            if (lower == "nan") return numeric_limits<T>::quiet_NaN();
-        }
-        
-        if (ss >> num)
+        const char* end = number.data() + number.size();
+        auto [at, ec] = from_chars(number.data(), end, num);
+        if (!number.empty() && ec == errc() && at == end)
             return num;
-        
-        throw ERROR("Invalid input string (not a number): " + EMPTY_OR(str));
+        throw ERROR("Invalid input string (not a number): " + EMPTY_OR(string(str)));
     }
 }
 
-// Specialization for bool
-template <>
-bool parse<bool>(const string& str) {
-    string lower = str;
-    transform(lower.begin(), lower.end(), lower.begin(), ::tolower);        
-    if (in_array(lower, vector<string>({ "true", "on", "1", "yes"}))) return true;
-    if (in_array(lower, vector<string>({ "false", "off", "0", "no"}))) return false;
-    throw ERROR("Invalid input string (not a boolean): " + EMPTY_OR(str));
+template <typename T>
+T parse(const string& str) {
+    return parse<T>(string_view(str));
 }
 
+template <typename T>
+T parse(const char* str) {
+    return parse<T>(string_view(str));
+}
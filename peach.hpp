@@ -1,6 +1,8 @@
 #pragma once
 
 #include <functional>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
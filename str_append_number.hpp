@@ -0,0 +1,31 @@
+#pragma once
+
+#include <charconv>
+#include <string>
+#include <type_traits>
+
+using namespace std;
+
+// Appends the shortest text that parses back (parse<T>) to the same value,
+// 0.1f is "0.1" where to_string() gives "0.100000" and 1e-7f would be
+// "0.000000". Infinities and NaN come out as inf, -inf and nan, booleans as
+// 1 and 0. Nothing is allocated when out has the capacity, so a cleared
+// buffer can be reused for any number of values.
+template<typename T>
+void str_append_number(string& out, T value) {
+    static_assert(is_arithmetic_v<T>, "str_append_number() needs an arithmetic type");
+    if constexpr (is_same_v<T, bool>) {
+        out += value ? '1' : '0';
+    } else {
+        char buffer[64];
+        auto [end, ec] = to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, ec == errc() ? end - buffer : 0);
+    }
+}
+
+template<typename T>
+string str_number(T value) {
+    string out;
+    str_append_number(out, value);
+    return out;
+}
@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include "ERROR.hpp"
+#include "SerialReader.hpp"
 
 using namespace std;
 
@@ -25,3 +26,17 @@ string str_deserialize(const vector<S>& serialized, size_t& nxt) {
         str += static_cast<char>(serialized[nxt++]);
     return str;
 }
+
+template<typename S>
+string str_deserialize(SerialReader<S>& reader) {
+    span<const S> head = reader.read(4);
+    size_t size = (static_cast<size_t>(static_cast<unsigned char>(head[0])) << 24) |
+                  (static_cast<size_t>(static_cast<unsigned char>(head[1])) << 16) |
+                  (static_cast<size_t>(static_cast<unsigned char>(head[2])) << 8) |
+                  static_cast<size_t>(static_cast<unsigned char>(head[3]));
+    span<const S> chars = reader.read(size);
+    string str(size, '\0');
+    for (size_t n = 0; n < size; n++)
+        str[n] = static_cast<char>(chars[n]);
+    return str;
+}
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <string>
+#include "SerialWriter.hpp"
 
 using namespace std;
 
@@ -18,3 +19,16 @@ vector<S> str_serialize(const string& str) {
         serialized.push_back(static_cast<S>(c));
     return serialized;
 }
+
+// Same layout, written in place
+template<typename S>
+void str_serialize(SerialWriter<S>& writer, const string& str) {
+    size_t size = str.size();
+    span<S> out = writer.extend(4 + size);
+    out[0] = static_cast<S>((size >> 24) & 0xFF);
+    out[1] = static_cast<S>((size >> 16) & 0xFF);
+    out[2] = static_cast<S>((size >> 8) & 0xFF);
+    out[3] = static_cast<S>(size & 0xFF);
+    for (size_t n = 0; n < size; n++)
+        out[4 + n] = static_cast<S>(str[n]);
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "../TEST.hpp"
+#include "../Columnar.hpp"
+
+#ifdef TEST
+
+#include "../str_contains.hpp"
+#include "../datetime_defs.hpp"
+#include "../file_copy.hpp"
+#include <filesystem>
+
+struct test_Columnar_Tick {
+    time_ms time;
+    float price;
+    int32_t volume;
+};
+
+static vector<test_Columnar_Tick> test_Columnar_ticks(size_t n) {
+    vector<test_Columnar_Tick> ticks;
+    for (size_t i = 0; i < n; i++)
+        ticks.push_back({ 1700000000000LL + (time_ms)i * 250 + (time_ms)(i % 7), 100.0f + (float)(i % 50), (int32_t)(i % 13) - 6 });
+    return ticks;
+}
+
+TEST(test_Columnar_roundtrip) {
+    string dir = "/tmp/test_Columnar";
+    vector<test_Columnar_Tick> ticks = test_Columnar_ticks(10000);
+    column_save(dir, "time", ticks, &test_Columnar_Tick::time, COLUMN_DELTA_PACKED, 1000);
+    column_save(dir, "price", ticks, &test_Columnar_Tick::price, COLUMN_RAW, 1000);
+    column_save(dir, "volume", ticks, &test_Columnar_Tick::volume, COLUMN_DELTA_PACKED, 1000);
+
+    ColumnReader<time_ms> times(dir, "time");
+    ColumnReader<float> prices(dir, "price");
+    ColumnReader<int32_t> volumes(dir, "volume");
+    assert(times.rows() == 10000 && prices.rows() == 10000 && times.blocks().size() == 10);
+    assert(times.blocks()[0].encoding == COLUMN_DELTA_PACKED && times.blocks()[0].bits < 16 && "deltas of 250 +- 6 are small");
+    assert(prices.blocks()[3].min == 100.0f && prices.blocks()[3].max == 149.0f);
+
+    vector<time_ms> t = times.read(0, 10000);
+    vector<int32_t> v = volumes.read(995, 2010); // crosses blocks
+    vector<float> p = prices.read(9990, 10000);
+    for (size_t i = 0; i < 10000; i++) assert(t[i] == ticks[i].time);
+    for (size_t i = 0; i < v.size(); i++) assert(v[i] == ticks[995 + i].volume);
+    for (size_t i = 0; i < p.size(); i++) assert(p[i] == ticks[9990 + i].price);
+    assert(times.read(5, 5).empty());
+    filesystem::remove_all(dir);
+}
+
+TEST(test_Columnar_scan_skips_blocks) {
+    string dir = "/tmp/test_Columnar";
+    vector<time_ms> times;
+    for (time_ms i = 0; i < 5000; i++) times.push_back(i * 10);
+    column_save(dir, "sorted", times, COLUMN_DELTA_PACKED, 500);
+    ColumnReader<time_ms> reader(dir, "sorted");
+    size_t visited = 0, first = 0;
+    for (const ColumnBlock<time_ms>& block: reader.blocks())
+        if (!(block.max < 12000 || 12990 < block.min)) visited++;
+    assert(visited == 1 && "only one block holds the range");
+    size_t found = reader.scan(12000, 12990, [&](size_t row, time_ms value) {
+        if (!first) first = row;
+        assert(value == (time_ms)row * 10);
+    });
+    assert(found == 100 && first == 1200);
+    filesystem::remove_all(dir);
+}
+
+TEST(test_Columnar_constant_block_before_varying) {
+    string dir = "/tmp/test_Columnar";
+    vector<int64_t> values = { 7, 7, 7, 7, 100, 101, 102, 103 };
+    column_save(dir, "steps", values, COLUMN_DELTA_PACKED, 4);
+    ColumnReader<int64_t> reader(dir, "steps");
+    assert(reader.blocks()[0].bits == 0 && reader.blocks()[0].offset == reader.blocks()[1].offset && "the constant block has no data bytes");
+    assert(reader.read(0, 8) == values);
+    assert(reader.read(4, 8) == vector<int64_t>({ 100, 101, 102, 103 }));
+    vector<int64_t> found;
+    reader.scan(0, 200, [&found](size_t, int64_t value) { found.push_back(value); });
+    assert(found == values && "the second block is decoded, not served from the first one");
+    filesystem::remove_all(dir);
+}
+
+TEST(test_Columnar_extreme_values) {
+    string dir = "/tmp/test_Columnar";
+    vector<int64_t> wild = { INT64_MIN, INT64_MAX, 0, -1, INT64_MAX, INT64_MIN, 42 };
+    column_save(dir, "wild", wild, COLUMN_DELTA_PACKED, 4);
+    ColumnReader<int64_t> reader(dir, "wild");
+    assert(reader.read(0, wild.size()) == wild && "wrapping deltas decode exactly");
+    vector<uint8_t> same(1000, 7);
+    column_save(dir, "same", same, COLUMN_DELTA_PACKED);
+    ColumnReader<uint8_t> constant(dir, "same");
+    assert(constant.blocks()[0].bits == 0 && constant.read(0, 1000) == same);
+    vector<int> empty;
+    column_save(dir, "empty", empty);
+    assert(ColumnReader<int>(dir, "empty").rows() == 0);
+    filesystem::remove_all(dir);
+}
+
+TEST(test_Columnar_errors) {
+    string dir = "/tmp/test_Columnar";
+    vector<float> floats = { 1.0f };
+    bool threw = false;
+    try {
+        column_save(dir, "floats", floats, COLUMN_DELTA_PACKED);
+    } catch (const exception& e) {
+        threw = str_contains(e.what(), "Delta packing needs an integer column");
+    }
+    assert(threw);
+    column_save(dir, "floats", floats);
+    ColumnReader<float> reader(dir, "floats");
+    threw = false;
+    try {
+        reader.read(0, 2);
+    } catch (const exception& e) {
+        threw = str_contains(e.what(), "out of bounds");
+    }
+    assert(threw);
+    threw = false;
+    try {
+        ColumnReader<double> wrong(dir, "floats");
+    } catch (const exception& e) {
+        threw = str_contains(e.what(), "element size mismatch");
+    }
+    assert(threw);
+    filesystem::remove_all(dir);
+}
+
+TEST(test_Columnar_mismatched_files) {
+    string dir = "/tmp/test_Columnar";
+    vector<int> first = { 1, 2, 3 }, second = { 4, 5, 6, 7, 8, 9, 10, 11 };
+    column_save(dir, "ints", first, COLUMN_RAW, 2);
+    file_copy(dir + "/ints.index", dir + "/ints.index.old", true);
+    column_save(dir, "ints", second, COLUMN_RAW, 4);
+    assert(ColumnReader<int>(dir, "ints").read(0, 8) == second);
+    // a reader between the two renames of a writer: new data, old index
+    filesystem::rename(dir + "/ints.index.old", dir + "/ints.index");
+    bool threw = false;
+    try {
+        ColumnReader<int> reader(dir, "ints");
+    } catch (const exception& e) {
+        threw = str_contains(e.what(), "different writes");
+    }
+    assert(threw);
+    filesystem::remove_all(dir);
+}
+
+#endif
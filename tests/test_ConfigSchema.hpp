@@ -0,0 +1,109 @@
+#pragma once
+
+#include "../TEST.hpp"
+#include "../ConfigSchema.hpp"
+
+#ifdef TEST
+
+#include "../str_contains.hpp"
+#include <thread>
+
+struct TestConfigSchemaServer {
+    string host;
+    int port = 0;
+    bool debug = false;
+    vector<string> tags;
+};
+
+const auto test_ConfigSchema_server = config_schema<TestConfigSchemaServer>(
+    config_field(&TestConfigSchemaServer::host, ".server.host", "localhost"),
+    config_field(&TestConfigSchemaServer::port, ".server.port").arg("port")
+        .check([](const int& port) { return port > 0 && port < 65536; }, "1..65535"),
+    config_field(&TestConfigSchemaServer::debug, ".debug", false),
+    config_field(&TestConfigSchemaServer::tags, ".tags", vector<string>())
+);
+
+string test_ConfigSchema_error(const JSON& json) {
+    try {
+        test_ConfigSchema_server.bind(json);
+    } catch (const exception& e) {
+        return e.what();
+    }
+    return "";
+}
+
+TEST(test_ConfigSchema_bind_json) {
+    JSON json(R"({"server": {"port": 8080}, "tags": ["a", "b"]})");
+    TestConfigSchemaServer config = test_ConfigSchema_server.bind(json);
+    assert(config.host == "localhost" && "missing fields take the default");
+    assert(config.port == 8080);
+    assert(!config.debug);
+    assert((config.tags == vector<string>{ "a", "b" }));
+}
+
+TEST(test_ConfigSchema_all_errors_reported) {
+    string error = test_ConfigSchema_error(JSON(R"({"server": {"host": 1}, "debug": "x"})"));
+    assert(str_contains(error, ".server.host: "));
+    assert(str_contains(error, ".server.port: missing"));
+    assert(str_contains(error, ".debug: "));
+    error = test_ConfigSchema_error(JSON(R"({"server": {"port": 70000}})"));
+    assert(str_contains(error, ".server.port: invalid value, expected 1..65535"));
+}
+
+TEST(test_ConfigSchema_path_needs_leading_dot) {
+    for (const char* path: { "server.port", "", "." }) {
+        string error;
+        try {
+            config_field(&TestConfigSchemaServer::port, path);
+        } catch (const exception& e) {
+            error = e.what();
+        }
+        assert(str_contains(error, "Config field path has to start with '.'"));
+    }
+}
+
+TEST(test_ConfigSchema_layered_sources) {
+    JSON json(R"({"server": {"host": "json", "port": 1}, "debug": true})");
+    IniData ini;
+    ini.set<string>("host", "ini", "server");
+    ini.set<int>("port", 2, "server");
+    char* argv[] = {(char*)"program", (char*)"--port", (char*)"3"};
+    Arguments args(3, argv);
+    args.addHelp("port", "server port");
+    TestConfigSchemaServer config = test_ConfigSchema_server.bind(ConfigSources{ &json, &ini, &args });
+    assert(config.host == "ini");
+    assert(config.port == 3 && "arguments override the files");
+    assert(config.debug);
+    config = test_ConfigSchema_server.bind(ini);
+    assert(config.port == 2);
+}
+
+TEST(test_ConfigSchema_live_reload) {
+    ConfigLive<TestConfigSchemaServer> live(test_ConfigSchema_server.bind(JSON(R"({"server": {"port": 1}})")));
+    shared_ptr<const TestConfigSchemaServer> before = live.get();
+    live.reload(test_ConfigSchema_server, JSON(R"({"server": {"port": 2}})"));
+    assert(before->port == 1 && "snapshots taken before a reload stay valid");
+    assert(live.get()->port == 2);
+    bool thrown = false;
+    try {
+        live.reload(test_ConfigSchema_server, JSON(R"({"server": {}})"));
+    } catch (const exception&) {
+        thrown = true;
+    }
+    assert(thrown && live.get()->port == 2 && "a failed reload keeps the running config");
+
+    atomic<bool> done = false;
+    thread reader([&]() {
+        while (!done) {
+            int port = live.get()->port;
+            assert(port >= 2 && port <= 100);
+        }
+    });
+    for (int port = 3; port <= 100; port++)
+        live.reload(test_ConfigSchema_server, JSON("{\"server\": {\"port\": " + to_string(port) + "}}"));
+    done = true;
+    reader.join();
+    assert(live.get()->port == 100);
+}
+
+#endif
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "../TEST.hpp"
+#include "../FileLogger.hpp"
+
+#ifdef TEST
+
+#include "../file_exists.hpp"
+#include "../file_get_contents.hpp"
+#include "../file_put_contents.hpp"
+#include "../str_ends_with.hpp"
+
+vector<string> test_FileLogger_segments(const string& dir) {
+    vector<string> segments;
+    for (const fs::directory_entry& entry: fs::directory_iterator(dir))
+        if (entry.path().filename().string() != "test.log")
+            segments.push_back(entry.path().string());
+    return segments;
+}
+
+TEST(test_FileLogger_write_no_rotation) {
+    string dir = "test_FileLogger_no_rotation";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    {
+        FileLogger logger(dir + "/test.log");
+        logger.write("first");
+        logger.write("second");
+    }
+    assert(file_get_contents(dir + "/test.log") == "first\nsecond\n");
+    assert(test_FileLogger_segments(dir).empty());
+    fs::remove_all(dir);
+}
+
+TEST(test_FileLogger_rotate_by_size) {
+    string dir = "test_FileLogger_rotate_by_size";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    {
+        FileLogger logger(dir + "/test.log", 10);
+        logger.write("0123456789"); // rotates
+        logger.write("abc");
+    }
+    assert(file_get_contents(dir + "/test.log") == "abc\n");
+    vector<string> segments = test_FileLogger_segments(dir);
+    assert(segments.size() == 1);
+    assert(file_get_contents(segments[0]) == "0123456789\n");
+    fs::remove_all(dir);
+}
+
+TEST(test_FileLogger_rotate_by_interval) {
+    string dir = "test_FileLogger_rotate_by_interval";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    {
+        FileLogger logger(dir + "/test.log", 0, 20);
+        logger.write("before");
+        this_thread::sleep_for(chrono::milliseconds(30));
+        logger.write("after"); // rotates after writing
+        logger.write("next");
+    }
+    assert(file_get_contents(dir + "/test.log") == "next\n");
+    assert(test_FileLogger_segments(dir).size() == 1);
+    fs::remove_all(dir);
+}
+
+TEST(test_FileLogger_retention) {
+    string dir = "test_FileLogger_retention";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    {
+        FileLogger logger(dir + "/test.log", 1, 0, 2);
+        for (int i = 0; i < 5; i++) logger.write(to_string(i));
+        logger.wait();
+    }
+    vector<string> segments = test_FileLogger_segments(dir);
+    assert(segments.size() == 2);
+    sort(segments.begin(), segments.end());
+    assert(file_get_contents(segments[0]) == "3\n");
+    assert(file_get_contents(segments[1]) == "4\n");
+    fs::remove_all(dir);
+}
+
+TEST(test_FileLogger_retention_keeps_other_files) {
+    string dir = "test_FileLogger_retention_other";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    for (const char* name: { "test.log.bak", "test.log.lock", "test.log.old", "test.log.20240101-000000.000.txt" })
+        file_put_contents(dir + "/" + name, "keep");
+    {
+        FileLogger logger(dir + "/test.log", 1, 0, 2);
+        for (int i = 0; i < 5; i++) logger.write(to_string(i));
+        logger.wait();
+    }
+    assert(test_FileLogger_segments(dir).size() == 6 && "Two segments and the four unrelated files");
+    assert(file_get_contents(dir + "/test.log.bak") == "keep");
+    assert(file_get_contents(dir + "/test.log.20240101-000000.000.txt") == "keep");
+    fs::remove_all(dir);
+}
+
+TEST(test_FileLogger_compress) {
+    string dir = "test_FileLogger_it's compressed"; // no shell involved
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    {
+        FileLogger logger(dir + "/test.log", 10, 0, 0, true);
+        logger.write("0123456789"); // rotates
+        logger.wait();
+    }
+    vector<string> segments = test_FileLogger_segments(dir);
+    assert(segments.size() == 1);
+    assert(str_ends_with(segments[0], ".gz"));
+    gzFile in = gzopen(segments[0].c_str(), "rb");
+    assert(in);
+    char buffer[64] = {};
+    int n = gzread(in, buffer, sizeof(buffer));
+    gzclose(in);
+    assert(string(buffer, n) == "0123456789\n");
+    fs::remove_all(dir);
+}
+
+#endif
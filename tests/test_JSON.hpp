@@ -849,4 +849,167 @@ TEST(test_JSON_set) {
     assert(actual == 42 && "Set value should update the JSON object");
 }
 
+TEST(test_JSONDocument_typed_accessors) {
+    JSONDocument doc("{\"s\": \"str\", \"i\": 42, \"d\": 3.5, \"b\": true, \"a\": [1, {\"x\": 2}], \"o\": {\"k\": null}}");
+    assert(doc.isValid());
+    assert(doc.getString(".s") == "str");
+    assert(doc.getInt(".i") == 42);
+    assert(doc.getDouble(".d") == 3.5);
+    assert(doc.getBool(".b") == true);
+    assert(doc.getArray(".a") == "[1,{\"x\":2}]");
+    assert(doc.getInt(".a[1].x") == 2);
+    assert(doc.getObject(".o") == "{\"k\":null}");
+    assert(doc.type(".o.k") == JSON_TYPE_NULL);
+    assert(doc.type(".missing") == JSON_TYPE_UNDEFINED);
+    assert(doc.has(".a[0]") && !doc.has(".a[5]"));
+}
+
+TEST(test_JSONDocument_type_mismatch) {
+    JSONDocument doc("{\"key\": 42}");
+    bool thrown = false;
+    try {
+        doc.getString(".key");
+    } catch (const exception& e) {
+        thrown = true;
+        assert(str_contains(e.what(), "Expected string type at .key"));
+    }
+    assert(thrown);
+}
+
+TEST(test_JSONDocument_invalid) {
+    JSONDocument doc("invalid json");
+    string error;
+    assert(!doc.isValid(&error));
+    assert(!error.empty());
+    assert(doc.type(".key") == JSON_TYPE_UNDEFINED);
+}
+
+TEST(test_JSONDocument_number_out_of_range) {
+    JSONDocument doc("{\"key\": 1e999}");
+    string error;
+    assert(!doc.isValid(&error));
+    assert(!error.empty());
+    assert(doc.type(".key") == JSON_TYPE_UNDEFINED);
+}
+
+TEST(test_json_document_cached) {
+    string jstring = "{\"key\": \"cached\"}";
+    shared_ptr<const JSONDocument> doc1 = json_document(jstring);
+    shared_ptr<const JSONDocument> doc2 = json_document(string(jstring));
+    assert(doc1 == doc2 && "Same text should give the same parsed document");
+    assert(json_document("{\"key\": \"other\"}") != doc1);
+    assert(json_get_string(jstring, ".key") == "cached");
+}
+
+TEST(test_json_document_cache_evicts) {
+    shared_ptr<const JSONDocument> first = json_document("{\"n\": -1}");
+    for (int i = 0; i < JSON_DOCUMENT_CACHE_SIZE; i++)
+        json_document("{\"n\": " + to_string(i) + "}");
+    assert(json_document("{\"n\": -1}") != first && "Least recently used document should be evicted");
+    assert(json_get_int("{\"n\": -1}", ".n") == -1);
+}
+
+TEST(test_json_selector_cached) {
+    const json::json_pointer* first = &json_selector(".cached.key[2]");
+    const json::json_pointer* second = &json_selector(".cached.key[2]");
+    assert(first == second && "Repeated selector should be resolved from the cache");
+    assert(*first == json::json_pointer("/cached/key/2"));
+}
+
+TEST(test_json_selector_whitespace_in_brackets) {
+    assert(_json_selector(".array[ 3 ]") == json::json_pointer("/array/3"));
+}
+
+TEST(test_json_selector_invalid_not_cached) {
+    for (int i = 0; i < 2; i++) {
+        bool thrown = false;
+        try {
+            json_selector(".key..key2");
+        } catch (const exception& e) {
+            thrown = true;
+            assert(str_contains(e.what(), "Invalid json selector: .key..key2"));
+        }
+        assert(thrown);
+    }
+}
+
+TEST(test_json_selector_to_pointer_constexpr) {
+    static_assert(json_selector_to_pointer(".a.b[3].c"));
+    static_assert(json_selector_to_pointer("a"));
+    static_assert(json_selector_to_pointer(""));
+    static_assert(!json_selector_to_pointer(".a..b"));
+    static_assert(!json_selector_to_pointer(".a[x]"));
+    static_assert(!json_selector_to_pointer(".a]x]"));
+    static_assert(!json_selector_to_pointer(".a~2"));
+    string pointer;
+    assert(json_selector_to_pointer(".a.b[3].c", &pointer) && pointer == "/a/b/3/c");
+}
+
+TEST(test_json_selector_literal) {
+    JSON json("{\"a\": {\"b\": [1, 2, {\"c\": 42}]}}");
+    assert(json.get<int>(JSONSelector(".a.b[2].c")) == 42);
+    assert(json.get<int>(".a.b[1]"_jsel) == 2);
+    assert(json.has(".a.b"_jsel));
+}
+
+TEST(test_json_fix_comment_before_closing) {
+    string input = "{\"a\": [1, 2, /* last */\n], // done\n}";
+    string expected = "{\"a\": [1, 2 \n] \n}";
+    assert(str_diffs_show(json_fix(input), expected).empty() && "Comma followed by a comment and a closer is trailing");
+}
+
+TEST(test_json_fix_needed) {
+    assert(!json_fix_needed(R"({"a": [1, 2], "b": {"c": 3}})"));
+    assert(!json_fix_needed(""));
+    assert(json_fix_needed(R"({"a": 1 // comment
+})"));
+    assert(json_fix_needed(R"({"a": /* c */ 1})"));
+    assert(json_fix_needed(R"({"a": [1, 2 , ]})"));
+    assert(json_fix_needed(R"({"url": "http://example.com"})") && "Strings are not looked into");
+    assert(json_fix(R"({"url": "http://example.com",})") == R"({"url": "http://example.com"})");
+}
+
+TEST(test_JSON_view_no_copy) {
+    JSON json(R"({"a": {"b": {"c": [1, 2, 3]}, "name": "x"}})");
+    JSONView a = json.view(".a");
+    assert(&a.get_json_cref() == &json.get_json_cref()["a"] && "View should point into the document");
+    assert(&json.view().get_json_cref() == &json.get_json_cref());
+    JSONView b = a.view(".b");
+    assert(b.get<int>(".c[2]") == 3);
+    assert(b.isArray(".c") && !b.isObject(".c") && !b.isNull(".c"));
+    assert(json.get<JSONView>(".a").get<string>(".name") == "x");
+    assert(json.get<JSON>(".a.b").dump() == b.dump());
+    bool thrown = false;
+    try {
+        a.get<int>(".missing");
+    } catch (const exception& e) {
+        thrown = true;
+        assert(str_contains(e.what(), "JSON Error at: .missing"));
+    }
+    assert(thrown);
+}
+
+TEST(test_JSON_copy_and_move) {
+    JSON broken("{\"a\": ");
+    JSON copy = broken; // used to share the error string
+    assert(!copy.isValid() && !broken.isValid());
+    JSON json(R"({"key": [1, 2, 3]})");
+    JSON moved = move(json);
+    assert(moved.get<int>(".key[1]") == 2);
+    copy = moved;
+    assert(copy.isValid() && copy.dump() == moved.dump());
+    copy = move(broken);
+    assert(!copy.isValid());
+}
+
+TEST(test_JSON_set_moves_value) {
+    JSON json;
+    nlohmann::json tree = nlohmann::json::parse(R"({"big": [1, 2, 3]})");
+    json.set(".tree", move(tree));
+    assert(json.get<int>(".tree.big[2]") == 3);
+    JSON sub(R"({"x": 1})");
+    json.set(".sub", move(sub));
+    assert(json.get<int>(".sub.x") == 1);
+}
+
 #endif
@@ -82,4 +82,19 @@ TEST(test_JSONExts_dump_multiple_jsons) {
     assert(actual == expected && "Dump should return correct JSON array string for multiple JSONs");
 }
 
+TEST(test_JSONExts_view_first_match) {
+    JSONExts exts;
+    exts.extends(JSON(R"({"nested": {"key": 1}})"));
+    exts.extends(JSON(R"({"nested": {"key": 2}})"));
+    JSONView view = exts.view("nested");
+    assert(view.get<int>(".key") == 2);
+    bool thrown = false;
+    try {
+        exts.view("missing");
+    } catch (const exception& e) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "../TEST.hpp"
+#include "../JSONLazy.hpp"
+
+#ifdef TEST
+
+#include "../str_contains.hpp"
+#include <thread>
+
+TEST(test_JSON_save_load_cbor) {
+    string filename = "test_JSON_save_load_cbor.cbor";
+    JSON json(R"({"a": {"b": [1, -2, 3.5, "x", null, true]}, "s": "text"})");
+    json.save_cbor(filename);
+    JSON loaded = JSON::load_cbor(filename);
+    assert(loaded.dump() == json.dump());
+    assert(loaded.get<double>(".a.b[2]") == 3.5);
+    remove(filename.c_str());
+}
+
+TEST(test_JSON_load_cbor_invalid) {
+    string filename = "test_JSON_load_cbor_invalid.cbor";
+    file_put_contents(filename, "\xff\xff");
+    bool thrown = false;
+    try {
+        JSON::load_cbor(filename);
+    } catch (const exception& e) {
+        thrown = true;
+        assert(str_contains(e.what(), "in: " + filename));
+    }
+    assert(thrown);
+    remove(filename.c_str());
+}
+
+TEST(test_JSONLazy_decodes_accessed_subtrees_only) {
+    string filename = "test_JSONLazy.cbor";
+    nlohmann::json j;
+    for (int i = 0; i < 100; i++)
+        j["section" + to_string(i)] = { { "id", i }, { "tags", { "a", "b", i } }, { "nested", { { "deep", to_string(i) } } } };
+    j["slash/key"] = "escaped";
+    json_save_cbor(filename, j);
+
+    JSONLazy lazy(filename);
+    assert(lazy.get<int>(".section42.id") == 42);
+    assert(lazy.get<int>(".section42.tags[2]") == 42);
+    assert(lazy.get<string>(".section99.nested.deep") == "99");
+    assert(lazy.decoded() == 3);
+    assert(lazy.get<int>(".section42.id") == 42);
+    assert(lazy.decoded() == 3 && "Decoded subtrees are kept");
+    assert(lazy.view(".section7").get<string>(".tags[1]") == "b");
+    assert(lazy.get<JSON>(".section7.nested").dump() == j["section7"]["nested"].dump());
+    assert(lazy.has(".section0.tags[1]"));
+    assert(!lazy.has(".section0.tags[3]"));
+    assert(!lazy.has(".section100"));
+    assert(!lazy.has(".section0.id.x"));
+    assert(lazy.view().get_json_cref() == j);
+    nlohmann::json escaped = lazy.view().get_json_cref()["slash/key"];
+    assert(escaped == "escaped");
+
+    bool thrown = false;
+    try {
+        lazy.get<int>(".missing");
+    } catch (const exception& e) {
+        thrown = true;
+        assert(str_contains(e.what(), "JSON Error at: .missing"));
+    }
+    assert(thrown);
+    remove(filename.c_str());
+}
+
+TEST(test_JSONLazy_concurrent_get) {
+    string filename = "test_JSONLazy_concurrent.cbor";
+    nlohmann::json j;
+    for (int i = 0; i < 50; i++) j["k" + to_string(i)] = { { "v", i } };
+    json_save_cbor(filename, j);
+    JSONLazy lazy(filename);
+    vector<thread> threads;
+    atomic<int> wrong = 0;
+    for (int t = 0; t < 8; t++)
+        threads.emplace_back([&lazy, &wrong, t]() {
+            for (int n = 0; n < 500; n++) {
+                int i = (n * 7 + t) % 50;
+                if (lazy.get<int>(".k" + to_string(i) + ".v") != i) wrong++;
+            }
+        });
+    for (thread& th: threads) th.join();
+    assert(wrong == 0);
+    assert(lazy.decoded() == 50);
+    remove(filename.c_str());
+}
+
+TEST(test_JSONLazy_indefinite_lengths) {
+    string filename = "test_JSONLazy_indefinite.cbor";
+    // {_ "a": [_ 1, 2], "b": (_ "x", "y"), "c": 3 } with indefinite map, array and string
+    file_put_contents(filename, string("\xbf\x61" "a" "\x9f\x01\x02\xff\x61" "b" "\x7f\x61" "x" "\x61" "y" "\xff\x61" "c" "\x03\xff", 20));
+    JSONLazy lazy(filename);
+    assert(lazy.get<int>(".a[1]") == 2);
+    assert(!lazy.has(".a[2]"));
+    assert(lazy.get<string>(".b") == "xy");
+    assert(lazy.get<int>(".c") == 3);
+    remove(filename.c_str());
+}
+
+#endif
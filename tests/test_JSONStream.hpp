@@ -0,0 +1,122 @@
+#pragma once
+
+#include "../TEST.hpp"
+#include "../JSONStream.hpp"
+
+#ifdef TEST
+
+#include "../str_contains.hpp"
+#include "../file_put_contents.hpp"
+
+// Feeds the input in every possible two-way split and in single bytes
+vector<nlohmann::json> test_JSONStream_records(const string& input, JSONStreamFormat format = JSON_STREAM_AUTO) {
+    vector<nlohmann::json> expected;
+    JSONStream whole([&expected](nlohmann::json&& record) { expected.push_back(move(record)); }, format);
+    whole.feed(input);
+    whole.finish();
+    for (size_t split = 0; split <= input.size(); split++) {
+        vector<nlohmann::json> records;
+        JSONStream stream([&records](nlohmann::json&& record) { records.push_back(move(record)); }, format);
+        stream.feed(input.substr(0, split));
+        stream.feed(input.substr(split));
+        stream.finish();
+        assert(records == expected);
+    }
+    vector<nlohmann::json> records;
+    JSONStream stream([&records](nlohmann::json&& record) { records.push_back(move(record)); }, format);
+    for (char c: input) stream.feed(&c, 1);
+    stream.finish();
+    assert(records == expected);
+    return expected;
+}
+
+void test_JSONStream_ignore(nlohmann::json&&) {}
+
+string test_JSONStream_error(const string& input, size_t max_record = JSON_STREAM_MAX_RECORD) {
+    const JSONStream::RecordCallback ignore = test_JSONStream_ignore;
+    try {
+        JSONStream stream(ignore, JSON_STREAM_AUTO, max_record);
+        for (size_t i = 0; i < input.size(); i += 10) stream.feed(input.substr(i, 10));
+        stream.finish();
+    } catch (const exception& e) {
+        return e.what();
+    }
+    return "";
+}
+
+TEST(test_JSONStream_lines) {
+    vector<nlohmann::json> records = test_JSONStream_records("{\"a\": 1}\n\n{\"a\": \"x\\ny\"}\r\n[1, 2]\n3");
+    assert(records.size() == 4);
+    assert(records[0]["a"] == 1);
+    assert(records[1]["a"] == "x\ny");
+    assert(records[2] == nlohmann::json::parse("[1, 2]"));
+    assert(records[3] == 3);
+}
+
+TEST(test_JSONStream_array) {
+    vector<nlohmann::json> records = test_JSONStream_records(" [ {\"s\": \"],[\\\"\"}, [1, [2]], \"t\" , 4.5, null,\n] ");
+    assert(records.size() == 5);
+    assert(records[0]["s"] == "],[\"");
+    assert(records[1] == nlohmann::json::parse("[1, [2]]"));
+    assert(records[2] == "t");
+    assert(records[3] == 4.5);
+    assert(records[4].is_null());
+    assert(test_JSONStream_records("[]").empty());
+}
+
+TEST(test_JSONStream_lines_forced) {
+    vector<nlohmann::json> records = test_JSONStream_records("[1]\n[2]\n", JSON_STREAM_LINES);
+    assert(records.size() == 2 && records[1] == nlohmann::json::parse("[2]"));
+}
+
+TEST(test_JSONStream_errors) {
+    assert(str_contains(test_JSONStream_error("{\"a\": 1}\n{bad}\n"), "Invalid JSON record at line 2"));
+    assert(str_contains(test_JSONStream_error("[1, 2"), "Unterminated JSON array after 1 record(s)"));
+    assert(str_contains(test_JSONStream_error("[1,,2]"), "Unexpected ','"));
+    assert(str_contains(test_JSONStream_error("[1] 2"), "Unexpected data after the JSON array"));
+    assert(str_contains(test_JSONStream_error("[\"" + string(100, 'x') + "\"]", 50), "JSON record is larger than 50 bytes"));
+}
+
+TEST(test_JSONStream_reader_pull) {
+    string filename = "test_JSONStream_reader.jsonl";
+    string content;
+    for (int i = 0; i < 1000; i++) content += "{\"i\": " + to_string(i) + "}\n";
+    file_put_contents(filename, content);
+    JSONStreamReader reader(filename, JSON_STREAM_AUTO, 100);
+    nlohmann::json record;
+    int expected = 0;
+    while (reader.next(record)) assert(record["i"] == expected++);
+    assert(expected == 1000);
+    assert(json_stream_file(filename, [](nlohmann::json&&) {}) == 1000);
+    remove(filename.c_str());
+}
+
+TEST(test_JSONStream_parallel) {
+    string filename = "test_JSONStream_parallel.jsonl";
+    string content;
+    long long expected = 0;
+    for (int i = 0; i < 5000; i++) {
+        content += "{\"i\": " + to_string(i) + ", \"pad\": \"" + string(i % 50, 'p') + "\"}\n";
+        expected += i;
+    }
+    file_put_contents(filename, content);
+    for (size_t threads: { 1, 3, 8 }) {
+        atomic<long long> sum = 0;
+        size_t count = jsonl_parse_parallel(filename, [&sum](nlohmann::json&& record) {
+            sum += record["i"].get<long long>();
+        }, threads, 1024);
+        assert(count == 5000);
+        assert(sum == expected);
+    }
+    file_put_contents(filename, content + "{broken\n");
+    string error;
+    try {
+        jsonl_parse_parallel(filename, [](nlohmann::json&&) {}, 4, 1024);
+    } catch (const exception& e) {
+        error = e.what();
+    }
+    assert(str_contains(error, "Invalid JSON record at line 5001:") && "the line in the file, not in the range");
+    remove(filename.c_str());
+}
+
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "../TEST.hpp"
+#include "../JSONWatcher.hpp"
+
+#ifdef TEST
+
+TEST(test_JSONWatcher_notifies_overlapping_paths) {
+    JSON conf(R"({"server": {"host": "a", "port": 1}, "log": {"level": "info"}, "list": [1, 2, 3]})");
+    JSONWatcher watcher(conf);
+    map<string, int> calls;
+    for (string selector: { "", ".server", ".server.port", ".server.host", ".log.level", ".list[2]" })
+        watcher.on(selector, [&calls, selector](const JSON&) { calls[selector]++; });
+
+    watcher.update(JSON(R"({"server": {"host": "a", "port": 2}, "log": {"level": "info"}, "list": [1, 2, 3]})"));
+    assert(calls[""] == 1 && calls[".server"] == 1 && calls[".server.port"] == 1);
+    assert(calls[".server.host"] == 0 && calls[".log.level"] == 0 && calls[".list[2]"] == 0);
+
+    watcher.patch(nlohmann::json::parse(R"([{"op": "replace", "path": "/server", "value": {"port": 3}}])"));
+    assert(calls[".server.host"] == 1 && calls[".server.port"] == 2 && "children of a replaced node are notified");
+
+    watcher.patch(nlohmann::json::parse(R"([{"op": "remove", "path": "/list/0"}])"));
+    assert(calls[".list[2]"] == 1 && "removing an element shifts the ones after it");
+
+    watcher.merge_patch(nlohmann::json::parse(R"({"log": {"level": "debug"}, "missing": null})"));
+    assert(calls[".log.level"] == 1 && calls[".server"] == 2);
+    assert(conf.get<string>(".log.level") == "debug");
+}
+
+TEST(test_JSONWatcher_off) {
+    JSON conf(R"({"a": 1})");
+    JSONWatcher watcher(conf);
+    int calls = 0;
+    size_t id = watcher.on(".a", [&calls](const JSON&) { calls++; });
+    assert(watcher.update(JSON(R"({"a": 2})")).size() == 1);
+    watcher.off(id);
+    watcher.update(JSON(R"({"a": 3})"));
+    assert(calls == 1);
+    assert(watcher.update(JSON(R"({"a": 3})")).empty());
+}
+
+#endif
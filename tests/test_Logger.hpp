@@ -0,0 +1,147 @@
+#pragma once
+
+#include "../TEST.hpp"
+#include "../Logger.hpp"
+
+#ifdef TEST
+
+#include "../str_contains.hpp"
+#include "../capture_cout.hpp"
+#include "../ConsoleLogger.hpp"
+
+class LoggerForTest: public Logger {
+public:
+    virtual ~LoggerForTest() { shutdown(); }
+    vector<string> outputs;
+protected:
+    void write(const string& output) override { outputs.push_back(output); }
+    string time() override { return ""; }
+};
+
+TEST(test_Logger_no_throttling_by_default) {
+    LoggerForTest logger;
+    for (int i = 0; i < 5; i++) logger.info("same", "@site");
+    assert(logger.outputs.size() == 5);
+    LogSuppressed suppressed = logger.suppressed();
+    assert(suppressed.limited == 0 && suppressed.sampled == 0 && suppressed.collapsed == 0);
+}
+
+TEST(test_Logger_rate_limit_per_site) {
+    LoggerForTest logger;
+    logger.set_rate_limit(0.001, 2);
+    for (int i = 0; i < 5; i++) logger.info("a" + to_string(i), "@site1");
+    for (int i = 0; i < 3; i++) logger.info("b" + to_string(i), "@site2");
+    assert(logger.outputs.size() == 4);
+    assert(logger.suppressed().limited == 4);
+}
+
+TEST(test_Logger_rate_limit_shared_by_threads) {
+    LoggerForTest logger;
+    logger.set_rate_limit(0.001, 2);
+    vector<thread> threads;
+    for (int t = 0; t < 4; t++)
+        threads.emplace_back([&logger]() {
+            for (int i = 0; i < 10; i++) logger.info("msg", "@site");
+        });
+    for (thread& t: threads) t.join();
+    assert(logger.outputs.size() == 2 && "One bucket for the call site, not one per thread");
+    assert(logger.suppressed().limited == 38);
+}
+
+TEST(test_Logger_rate_limit_notes_suppressed) {
+    LoggerForTest logger;
+    logger.set_rate_limit(100, 1);
+    logger.info("first", "@site");
+    logger.info("second", "@site"); // suppressed
+    this_thread::sleep_for(chrono::milliseconds(20));
+    logger.info("third", "@site");
+    assert(logger.outputs.size() == 2);
+    assert(str_contains(logger.outputs[1], "third (1 similar message(s) suppressed)"));
+}
+
+TEST(test_Logger_rate_limit_never_drops_throws) {
+    LoggerForTest logger;
+    logger.set_rate_limit(0.001, 1);
+    logger.error("first", "@site");
+    bool thrown = false;
+    try {
+        logger.error("second", "@site", true);
+    } catch (exception&) {
+        thrown = true;
+    }
+    assert(thrown);
+    assert(logger.outputs.size() == 2);
+}
+
+TEST(test_Logger_sampling_debug_only) {
+    LoggerForTest logger;
+    logger.set_sampling(0);
+    for (int i = 0; i < 10; i++) logger.debug("dbg" + to_string(i), "@site");
+    logger.info("info", "@site");
+    assert(logger.outputs.size() == 1);
+    assert(logger.suppressed().sampled == 10);
+}
+
+TEST(test_Logger_collapse_repeated) {
+    LoggerForTest logger;
+    logger.set_collapse(true);
+    for (int i = 0; i < 4; i++) logger.warning("storm", "@site");
+    logger.warning("calm", "@site");
+    assert(logger.outputs.size() == 3);
+    assert(str_contains(logger.outputs[0], "storm"));
+    assert(str_contains(logger.outputs[1], "Last message repeated 3 times"));
+    assert(str_contains(logger.outputs[2], "calm"));
+    assert(logger.suppressed().collapsed == 3);
+}
+
+TEST(test_Logger_collapse_flushed_when_next_is_dropped) {
+    LoggerForTest logger;
+    logger.set_collapse(true);
+    logger.set_sampling(0);
+    for (int i = 0; i < 3; i++) logger.warning("storm", "@site");
+    logger.debug("sampled out", "@site");
+    assert(logger.outputs.size() == 2);
+    assert(str_contains(logger.outputs[1], "Last message repeated 2 times"));
+}
+
+TEST(test_Logger_collapse_flushed_on_thread_exit) {
+    LoggerForTest logger;
+    logger.set_collapse(true);
+    thread([&logger]() {
+        for (int i = 0; i < 4; i++) logger.warning("storm", "@site");
+    }).join();
+    assert(logger.outputs.size() == 2);
+    assert(str_contains(logger.outputs[1], "Last message repeated 3 times"));
+}
+
+TEST(test_Logger_collapse_flushed_on_shutdown) {
+    string output = capture_cout([]() {
+        ConsoleLogger logger;
+        logger.set_collapse(true);
+        for (int i = 0; i < 3; i++) logger.warning("storm", "@site");
+    });
+    assert(str_contains(output, "storm"));
+    assert(str_contains(output, "Last message repeated 2 times"));
+
+    LoggerForTest logger;
+    logger.set_collapse(true);
+    for (int i = 0; i < 3; i++) logger.warning("storm", "@site");
+    logger.flush_repeats();
+    assert(logger.outputs.size() == 2);
+    assert(str_contains(logger.outputs[1], "Last message repeated 2 times"));
+}
+
+TEST(test_Logger_suppressed_across_threads) {
+    LoggerForTest logger;
+    logger.set_sampling(0);
+    vector<thread> threads;
+    for (int t = 0; t < 4; t++)
+        threads.emplace_back([&logger]() {
+            for (int i = 0; i < 100; i++) logger.debug("dbg", "@site");
+        });
+    for (thread& t: threads) t.join();
+    assert(logger.outputs.empty());
+    assert(logger.suppressed().sampled == 400);
+}
+
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "../TEST.hpp"
+#include "../MappedVector.hpp"
+
+#ifdef TEST
+
+#include "../str_contains.hpp"
+#include "../file_exists.hpp"
+#include "../unlink.hpp"
+#include "../file_put_contents.hpp"
+
+TEST(test_MappedVector_save_and_view) {
+    string filename = "/tmp/test_MappedVector.vec";
+    vector<double> data;
+    for (int i = 0; i < 10000; i++) data.push_back(i * 0.5);
+    vector_save_mapped(data, filename);
+    assert(!file_exists(filename + ".tmp") && "the temp file is renamed over");
+
+    MappedVector<double> view(filename, true, true);
+    assert(view.size() == 10000 && view[1234] == 617.0 && view.verify());
+    assert(((uintptr_t)view.data() % alignof(double)) == 0);
+    double sum = 0;
+    for (double x: view) sum += x;
+    assert(sum == 0.5 * 9999 * 10000 / 2);
+
+    vector<double> empty;
+    vector_save_mapped(empty, filename);
+    MappedVector<double> none(filename, false, true);
+    assert(none.empty());
+    unlink(filename);
+}
+
+TEST(test_MappedVector_append) {
+    string filename = "/tmp/test_MappedVector_append.vec";
+    if (file_exists(filename)) unlink(filename);
+    vector<int> a = { 1, 2, 3 }, b = { 4, 5 };
+    vector_append_mapped(a, filename); // creates it
+    vector_append_mapped(b, filename);
+    MappedVector<int> view(filename, false, true);
+    assert(view.size() == 5 && view[4] == 5 && view.verify() && "the checksum follows the appends");
+
+    vector<int> all = { 1, 2, 3, 4, 5 };
+    vector_save_mapped(all, filename + ".2");
+    MappedVector<int> saved(filename + ".2");
+    assert(saved.verify());
+    unlink(filename);
+    unlink(filename + ".2");
+}
+
+TEST(test_MappedVector_invalid) {
+    string filename = "/tmp/test_MappedVector_invalid.vec";
+    vector<int> data = { 1, 2, 3 };
+    vector_save_mapped(data, filename);
+    auto fails = [&](const string& what, bool verify = false) {
+        try {
+            MappedVector<int> view(filename, false, verify);
+        } catch (const exception& e) {
+            return str_contains(e.what(), what);
+        }
+        return false;
+    };
+    bool threw = false;
+    try {
+        MappedVector<double> view(filename);
+    } catch (const exception& e) {
+        threw = str_contains(e.what(), "element size mismatch, 4 != 8");
+    }
+    assert(threw);
+
+    int fd = ::open(filename.c_str(), O_RDWR);
+    int changed = 9;
+    assert(pwrite(fd, &changed, sizeof(changed), sizeof(MappedVectorHeader) + 4) == sizeof(changed));
+    assert(fails("checksum mismatch", true) && !fails("checksum mismatch", false));
+    assert(ftruncate(fd, sizeof(MappedVectorHeader) + 8) == 0);
+    ::close(fd);
+    assert(fails("truncated"));
+    unlink(filename);
+    file_put_contents(filename, "not a vector");
+    assert(fails("Not a mapped vector file"));
+    unlink(filename);
+}
+
+#endif
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "../TEST.hpp"
+#include "../Metrics.hpp"
+
+#ifdef TEST
+
+#include "../str_contains.hpp"
+#include "../file_get_contents.hpp"
+
+TEST(test_Metrics_counter_merges_threads) {
+    Metrics registry;
+    MetricsCounter& counter = registry.counter("requests_total");
+    vector<thread> threads;
+    for (int t = 0; t < 4; t++)
+        threads.emplace_back([&counter]() {
+            for (int i = 0; i < 1000; i++) counter.add();
+        });
+    for (thread& t: threads) t.join();
+    counter.add(5);
+    assert(counter.value() == 4005);
+    assert(&registry.counter("requests_total") == &counter && "same name should give the same counter");
+}
+
+TEST(test_Metrics_gauge) {
+    Metrics registry;
+    MetricsGauge& gauge = registry.gauge("queue_size");
+    gauge.set(10);
+    gauge.add(-2.5);
+    assert(gauge.value() == 7.5);
+}
+
+TEST(test_Metrics_histogram_buckets) {
+    for (uint64_t value: { 0ULL, 1ULL, 15ULL, 16ULL, 17ULL, 100ULL, 1000ULL, 123456789ULL, 18446744073709551615ULL }) {
+        size_t bucket = MetricsHistogramShard::bucket(value);
+        assert(bucket < MetricsHistogramShard::buckets);
+        assert(MetricsHistogramShard::lowest(bucket) <= value);
+        assert(MetricsHistogramShard::highest(bucket) >= value);
+    }
+    assert(MetricsHistogramShard::bucket(15) == 15);
+    assert(MetricsHistogramShard::bucket(1000) != MetricsHistogramShard::bucket(1100));
+}
+
+TEST(test_Metrics_histogram_percentiles) {
+    Metrics registry;
+    MetricsHistogram& histogram = registry.histogram("latency_ns");
+    for (uint64_t i = 1; i <= 1000; i++) histogram.record(i);
+    MetricsHistogram::Snapshot snapshot = histogram.snapshot();
+    assert(snapshot.count == 1000);
+    assert(snapshot.sum == 500500);
+    assert(snapshot.min == 1);
+    assert(snapshot.max == 1000);
+    uint64_t p50 = snapshot.percentile(0.5);
+    assert(p50 >= 500 && p50 <= 530);
+    uint64_t p99 = snapshot.percentile(0.99);
+    assert(p99 >= 990 && p99 <= 1000);
+}
+
+TEST(test_Metrics_timer) {
+    Metrics registry;
+    MetricsHistogram& histogram = registry.histogram("sleep_ns");
+    {
+        MetricsTimer timer(histogram);
+        this_thread::sleep_for(chrono::milliseconds(5));
+    }
+    MetricsHistogram::Snapshot snapshot = histogram.snapshot();
+    assert(snapshot.count == 1);
+    assert(snapshot.max >= 5'000'000);
+}
+
+TEST(test_Metrics_snapshot_prometheus) {
+    Metrics registry;
+    registry.counter("jobs.done", "Finished jobs").add(3);
+    registry.gauge("load").set(0.5);
+    registry.histogram("latency").record(42);
+    string text = registry.snapshot(METRICS_PROMETHEUS);
+    assert(str_contains(text, "# HELP jobs_done Finished jobs\n"));
+    assert(str_contains(text, "# TYPE jobs_done counter\njobs_done 3\n"));
+    assert(str_contains(text, "# TYPE load gauge\nload 0.5\n"));
+    assert(str_contains(text, "latency{quantile=\"0.5\"} 42\n"));
+    assert(str_contains(text, "latency_count 1\n"));
+}
+
+TEST(test_Metrics_snapshot_json) {
+    Metrics registry;
+    registry.counter("jobs").add(2);
+    registry.histogram("latency").record(7);
+    string json = registry.snapshot(METRICS_JSON);
+    assert(str_contains(json, "\"counters\":{\"jobs\":2}"));
+    assert(str_contains(json, "\"latency\":{\"count\":1,\"sum\":7,\"min\":7,\"max\":7"));
+}
+
+TEST(test_Metrics_snapshot_non_finite_and_help_escaping) {
+    Metrics registry;
+    registry.gauge("nan").set(NAN);
+    registry.gauge("inf", "Line one\nback\\slash").set(-INFINITY);
+    registry.histogram("empty");
+    string json = registry.snapshot(METRICS_JSON);
+    assert(str_contains(json, "\"nan\":null") && str_contains(json, "\"inf\":null"));
+    assert(!str_contains(json, "nan,") && !str_contains(json, "inf}") && !str_contains(json, ":-nan"));
+    string text = registry.snapshot(METRICS_PROMETHEUS);
+    assert(str_contains(text, "nan NaN\n") && str_contains(text, "inf -Inf\n"));
+    assert(str_contains(text, "# HELP inf Line one\\nback\\\\slash\n"));
+}
+
+TEST(test_Metrics_export_every) {
+    string filename = "test_Metrics_export.prom";
+    {
+        Metrics registry;
+        registry.counter("ticks").add();
+        registry.export_every(filename, 10);
+        this_thread::sleep_for(chrono::milliseconds(50));
+    }
+    assert(str_contains(file_get_contents(filename), "ticks 1\n"));
+    remove(filename.c_str());
+}
+
+#endif
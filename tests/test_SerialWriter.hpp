@@ -0,0 +1,89 @@
+#pragma once
+
+#include "../TEST.hpp"
+#include "../SerialWriter.hpp"
+#include "../SerialReader.hpp"
+
+#ifdef TEST
+
+#include "../str_contains.hpp"
+#include "../str_serialize.hpp"
+#include "../str_deserialize.hpp"
+#include "../Serializable_vector_serialize.hpp"
+#include "../Serializable_vector_deserialize.hpp"
+#include "../Value.hpp"
+
+TEST(test_SerialWriter_SerialReader_roundtrip) {
+    vector<uint32_t> out = { 99 };
+    SerialWriter<uint32_t> writer(out);
+    writer.write(7);
+    str_serialize(writer, "hello");
+    span<uint32_t> room = writer.extend(2);
+    room[0] = 1;
+    room[1] = 2;
+    assert(writer.size() == 1 + 1 + 4 + 5 + 2 && "appends after the existing slots");
+    assert(vector<uint32_t>(out.begin() + 2, out.begin() + 11) == str_serialize<uint32_t>("hello") && "same layout as str_serialize()");
+
+    SerialReader<uint32_t> reader(out, 1);
+    assert(reader.read() == 7);
+    assert(str_deserialize(reader) == "hello");
+    span<const uint32_t> rest = reader.read(2);
+    assert(rest[0] == 1 && rest[1] == 2 && reader.done() && reader.remaining() == 0);
+    bool threw = false;
+    try {
+        reader.read();
+    } catch (const exception& e) {
+        threw = str_contains(e.what(), "Serialized data is truncated");
+    }
+    assert(threw);
+}
+
+TEST(test_SerialWriter_Value_matches_serialize) {
+    vector<Value> values;
+    for (int i = 0; i < 1000; i++) values.push_back(Value((float)i, "v" + to_string(i), 0.0f, 1000.0f, 1.0f));
+    vector<uint32_t> legacy;
+    for (Value& value: values) {
+        vector<uint32_t> serialized = value.serialize();
+        assert(serialized.size() == value.size_hint());
+        legacy.insert(legacy.end(), serialized.begin(), serialized.end());
+    }
+    vector<uint32_t> serialized;
+    Serializable_vector_serialize(serialized, values);
+    assert(serialized.size() == legacy.size() + 1 && serialized[0] == 1000);
+    assert(equal(legacy.begin(), legacy.end(), serialized.begin() + 1) && "the streaming path writes the same slots");
+
+    vector<Value> loaded;
+    Value value;
+    SerialReader<uint32_t> reader(span<const uint32_t>(serialized.data(), serialized.size()));
+    Serializable_vector_deserialize(value, loaded, reader);
+    assert(reader.done() && loaded.size() == 1000);
+    assert(loaded[123].getNameCRef() == "v123" && loaded[123] == 123.0f && loaded[123].getStep() == 1.0f);
+}
+
+// Implements only the legacy interface, read() comes from the defaults
+class test_SerialWriter_Legacy: public Serializable<uint32_t> {
+public:
+    uint32_t value = 0;
+    vector<uint32_t> serialize() override {
+        return { value };
+    }
+    void deserialize(const vector<uint32_t>& serialized, size_t& nxt) override {
+        value = serialized[nxt++];
+    }
+};
+
+TEST(test_SerialWriter_legacy_Serializable) {
+    vector<test_SerialWriter_Legacy> items(3);
+    for (uint32_t i = 0; i < 3; i++) items[i].value = i + 10;
+    vector<uint32_t> serialized;
+    Serializable_vector_serialize(serialized, items);
+    assert((serialized == vector<uint32_t>{ 3, 10, 11, 12 }));
+
+    vector<test_SerialWriter_Legacy> loaded;
+    test_SerialWriter_Legacy item;
+    SerialReader<uint32_t> reader(span<const uint32_t>(serialized.data(), serialized.size()));
+    Serializable_vector_deserialize(item, loaded, reader);
+    assert(loaded.size() == 3 && loaded[2].value == 12 && reader.done());
+}
+
+#endif
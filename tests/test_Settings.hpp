@@ -5,6 +5,7 @@
 
 #ifdef TEST
 
+#include <thread>
 
 TEST(test_Settings_constructor_default) {
     Settings settings;
@@ -160,4 +161,81 @@ TEST(test_Settings_has_returns_false) {
     assert(actual == false && "Has should return false when key is missing in args, conf, and exts");
 }
 
+TEST(test_Settings_view_nested) {
+    JSON conf(R"({"db": {"host": "conf", "port": 1}})");
+    Settings settings(conf);
+    assert(settings.view("db").get<string>(".host") == "conf");
+    settings.extends(JSON(R"({"db": {"host": "ext"}})"));
+    assert(settings.view("db").get<string>(".host") == "ext");
+}
+
+TEST(test_Settings_get_cache_invalidation) {
+    JSON conf(R"({"port": 1, "name": "conf"})");
+    Settings settings(conf);
+    assert(settings.get<int>("port") == 1);
+    assert(settings.get<double>("port") == 1.0 && "each type is resolved on its own");
+    assert(settings.get<int>("missing", 7) == 7);
+    conf.set("port", 2);
+    assert(settings.get<int>("port") == 2 && "conf.set() should invalidate the cache");
+    conf.set("missing", 3);
+    assert(settings.get<int>("missing", 7) == 3 && "a cached miss should be dropped too");
+    settings.extends(JSON(R"({"port": 4})"));
+    assert(settings.get<int>("port") == 4 && "extends() should invalidate the cache");
+    settings.exts.set("port", 5);
+    assert(settings.get<int>("port") == 5 && "exts.set() should invalidate the cache");
+    assert(settings.has("name"));
+    assert(!settings.has("other"));
+    conf.get_json_ref()["other"] = true;
+    assert(settings.has("other") && "get_json_ref() counts as a change");
+    nlohmann::json& kept = conf.get_json_ref();
+    assert(settings.get<bool>("other"));
+    kept["other"] = false;
+    conf.touch();
+    assert(!settings.get<bool>("other") && "touch() after writing through a kept reference");
+    JSON other(R"({"port": 6})");
+    Settings copy = settings;
+    copy.exts = JSONExts();
+    copy.conf = &other;
+    assert(copy.get<int>("port") == 6);
+    assert(settings.get<int>("port") == 5);
+}
+
+TEST(test_Settings_get_concurrent) {
+    nlohmann::json j;
+    for (int i = 0; i < 40; i++) j["k" + to_string(i)] = i;
+    JSON conf(j.dump());
+    Settings settings(conf);
+    vector<thread> threads;
+    atomic<int> wrong = 0;
+    for (int t = 0; t < 8; t++)
+        threads.emplace_back([&settings, &wrong, t]() {
+            for (int n = 0; n < 400; n++) {
+                int i = (n * 3 + t) % 50; // k40..k49 are missing
+                string key = "k" + to_string(i);
+                bool present = i < 40;
+                if (settings.has(key) != present) wrong++;
+                if (settings.get<int>(key, -1) != (present ? i : -1)) wrong++;
+                if (present && settings.get<double>(key) != i) wrong++;
+            }
+        });
+    for (thread& th: threads) th.join();
+    assert(wrong == 0);
+}
+
+TEST(test_Settings_hash_tracks_changes) {
+    JSON conf(R"({"a": 1})");
+    Settings settings(conf);
+    string first = settings.hash();
+    assert(settings.hash() == first);
+    conf.set("a", 2);
+    string second = settings.hash();
+    assert(second != first);
+    assert(second == get_hash("<noexts>" + conf.dump() + "<noargs>"));
+    settings.extends(JSON(R"({"b": 1})"));
+    assert(settings.hash() == get_hash(settings.exts.dump() + conf.dump() + "<noargs>"));
+    conf.set("a", 1);
+    settings.exts = JSONExts();
+    assert(settings.hash() == first && "equal contents give equal hashes");
+}
+
 #endif
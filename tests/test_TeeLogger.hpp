@@ -0,0 +1,85 @@
+#pragma once
+
+#include "../TEST.hpp"
+#include "../TeeLogger.hpp"
+
+#ifdef TEST
+
+#include "../str_contains.hpp"
+#include "../Stopper.hpp"
+
+class TeeLoggerSinkForTest: public Logger {
+public:
+    TeeLoggerSinkForTest(LogLevel level = LOGLVL_ALL, int delay_ms = 0): delay_ms(delay_ms) { set_level_output(level); }
+    vector<string> outputs;
+protected:
+    void write(const string& output) override {
+        if (delay_ms) this_thread::sleep_for(chrono::milliseconds(delay_ms));
+        outputs.push_back(output);
+    }
+    int delay_ms;
+};
+
+TEST(test_TeeLogger_fan_out_per_sink_level) {
+    TeeLoggerSinkForTest console(LOGLVL_INFO);
+    TeeLoggerSinkForTest file(LOGLVL_DEBUG);
+    TeeLogger tee({ &console, &file });
+    tee.info("info message", "@site");
+    tee.debug("debug message", "@site");
+    tee.flush();
+    assert(console.outputs.size() == 1);
+    assert(str_contains(console.outputs[0], "info message"));
+    assert(file.outputs.size() == 2);
+    assert(file.outputs[0] == console.outputs[0] && "the record should be formatted once");
+    assert(str_contains(file.outputs[1], "debug message"));
+}
+
+TEST(test_TeeLogger_slow_sink_does_not_stall_others) {
+    TeeLoggerSinkForTest fast;
+    TeeLoggerSinkForTest slow(LOGLVL_ALL, 50);
+    TeeLogger tee({ &fast, &slow });
+    Stopper stopper;
+    for (int i = 0; i < 3; i++) tee.info(to_string(i), "@site");
+    assert(stopper.stop() < 50 && "logging should not wait for the slow sink");
+    tee.flush();
+    assert(fast.outputs.size() == 3);
+    assert(slow.outputs.size() == 3);
+}
+
+TEST(test_TeeLogger_capacity_drops_and_counts) {
+    TeeLoggerSinkForTest slow(LOGLVL_ALL, 20);
+    TeeLogger tee({ &slow });
+    tee.set_capacity(2);
+    for (int i = 0; i < 10; i++) tee.info(to_string(i), "@site");
+    tee.flush();
+    size_t dropped = tee.suppressed().dropped;
+    assert(dropped >= 5 && "the stalled sink keeps at most 2 queued");
+    assert(slow.outputs.size() + dropped == 10);
+}
+
+TEST(test_TeeLogger_keeps_order) {
+    TeeLoggerSinkForTest sink;
+    {
+        TeeLogger tee({ &sink });
+        for (int i = 0; i < 100; i++) tee.note(to_string(i), "");
+    } // destructor drains the queues
+    assert(sink.outputs.size() == 100);
+    for (int i = 0; i < 100; i++)
+        assert(str_contains(sink.outputs[i], "] " + to_string(i)));
+}
+
+TEST(test_TeeLogger_throws) {
+    TeeLoggerSinkForTest sink;
+    TeeLogger tee({ &sink });
+    bool thrown = false;
+    try {
+        tee.throws("boom", "@site");
+    } catch (exception&) {
+        thrown = true;
+    }
+    tee.flush();
+    assert(thrown);
+    assert(sink.outputs.size() == 1);
+}
+
+#endif
@@ -2,6 +2,8 @@
 
 #include "../TEST.hpp"
 #include "../Values.hpp"
+#include "../unlink.hpp"
+#include "../capture_cout.hpp"
 
 #ifdef TEST
 
@@ -197,4 +199,140 @@ TEST(test_Values_dump_without_show) {
 //     assert(threw && "save should throw for invalid file mode");
 // }
 
+// Handles resolve the name once and survive other names coming and going
+TEST(test_Values_handles) {
+    Values values;
+    for (int i = 0; i < 1000; i++) values.add("p" + to_string(i), (float)i);
+    Values::Handle h = values.handle("p500");
+    assert(values.get(h) == 500.0f);
+    values.set(h, 1.5f);
+    assert(values.get<float>("p500") == 1.5f);
+    values.remove("p10");
+    assert(!values.has("p10") && values.size() == 999);
+    assert(values[h].getNameCRef() == "p500" && values.get(h) == 1.5f);
+    Values::Handle removed = values.handle("p20");
+    values.remove("p20");
+    assert(!values.has(removed));
+    values.add("p20", 7);
+    assert(values.has(removed) && values.get(removed) == 7.0f && "a name keeps its handle");
+    bool threw = false;
+    try {
+        values.handle("missing");
+    } catch (const exception& e) {
+        threw = str_contains(e.what(), "Value not found");
+    }
+    assert(threw);
+}
+
+TEST(test_Values_index_follows_changes) {
+    Values values;
+    values.push_back(Value(1.0f, "a"));
+    values.push_back(Value(2.0f, "b"));
+    values.push_back(Value(3.0f, "a"));
+    assert(values.get<float>("a") == 1.0f && "the first value of a name is found");
+    values[0] = Value(4.0f, "c");
+    values.reindex();
+    assert(values.get<float>("c") == 4.0f && values.get<float>("a") == 3.0f);
+    values.setBlock(values.getBlock());
+    assert(values.get<float>("b") == 2.0f);
+    values.clear();
+    assert(!values.has("b"));
+}
+
+TEST(test_Values_pack_unpack) {
+    Values values;
+    values.push_back(Value(2.5f, "a", -10.0f, 10.0f, 0.5f));
+    values.push_back(Value(3.0f, "b", 0.0f, 5.0f, NAN, true, true, true, false));
+    values.push_back(Value(-INFINITY, "", -INFINITY, 0.0f));
+    vector<char> buffer = values.pack();
+    assert(buffer.size() == values.packedSize());
+    assert(string(buffer.data(), 4) == "VALS" && buffer[4] == 1 && buffer[5] == 0 && buffer[6] == sizeof(float));
+    assert(buffer[8] == 3 && "the count is little-endian");
+
+    Values loaded;
+    loaded.push_back(Value(1.0f, "old"));
+    assert(loaded.unpack(buffer.data(), buffer.size()) == buffer.size());
+    assert(loaded.size() == 3 && !loaded.has("old"));
+    assert(loaded.get<float>("a") == 2.5f && loaded["a"].getStep() == 0.5f && loaded["a"].getUpper() == 10.0f);
+    const Value& b = loaded["b"];
+    assert(b.isConstant() && b.isRounded() && b.isClips() && !b.isThrows() && b.getValue() == 3.0f);
+    assert(loaded[2].getValue() == -INFINITY && loaded[2].getNameCRef().empty());
+
+    buffer[6] = sizeof(double);
+    bool threw = false;
+    try {
+        loaded.unpack(buffer);
+    } catch (const exception& e) {
+        threw = str_contains(e.what(), "real size mismatch, 8 != 4");
+    }
+    assert(threw && loaded.size() == 3);
+}
+
+TEST(test_Values_unpack_invalid) {
+    Values values;
+    values.push_back(Value(1.0f, "a", 0.0f, 2.0f));
+    vector<char> buffer = values.pack();
+    auto fails = [](const vector<char>& data, const string& what) {
+        Values target;
+        target.push_back(Value(5.0f, "kept"));
+        try {
+            target.unpack(data);
+        } catch (const exception& e) {
+            return str_contains(e.what(), what) && target.has("kept");
+        }
+        return false;
+    };
+    assert(fails(vector<char>(buffer.begin(), buffer.end() - 1), "truncated"));
+    vector<char> bad = buffer;
+    bad[0] = 'X';
+    assert(fails(bad, "invalid header"));
+    bad = buffer;
+    bad[4] = 9;
+    assert(fails(bad, "unsupported version 9"));
+    bad = buffer;
+    float lower = 3.0f; // lower > upper
+    memcpy(bad.data() + 16 + 4 + 1 + sizeof(float), &lower, sizeof(float));
+    assert(fails(bad, "Invalid bounds"));
+    bool threw = false;
+    try {
+        char small[8];
+        values.pack(small, sizeof(small));
+    } catch (const exception& e) {
+        threw = str_contains(e.what(), "buffer too small");
+    }
+    assert(threw);
+}
+
+TEST(test_Values_savePacked_loadPacked) {
+    string filename = "/tmp/test_Values_packed.bin";
+    Values values;
+    for (int i = 0; i < 100; i++) values.push_back(Value((float)i, "p" + to_string(i), 0.0f, 100.0f));
+    values.savePacked(filename);
+    Values loaded;
+    loaded.loadPacked(filename);
+    assert(loaded.size() == 100 && loaded.get<float>("p42") == 42.0f && loaded["p99"].getUpper() == 100.0f);
+    Values empty;
+    empty.savePacked(filename);
+    loaded.loadPacked(filename);
+    assert(loaded.empty());
+    unlink(filename.c_str());
+}
+
+TEST(test_Values_getAsIniText_roundtrip) {
+    string filename = "/tmp/test_Values_ini.ini";
+    Values values;
+    values.push_back(Value(0.1f, "a", -1e-7f, 10.0f, NAN, false, false, true));
+    values.push_back(Value(3.0f, "b", -INFINITY, INFINITY, 0.5f, true));
+    string text = values.getAsIniText();
+    assert(str_contains(text, "[a]\nvalue=0.1\nlower=-1e-07\nupper=10\nstep=nan\n") && "shortest round trip numbers");
+    assert(!str_contains(text, "name=") && "the section is the name");
+    values.saveIni(filename);
+    Values loaded;
+    capture_cout([&]() { loaded.init(filename, false, true); }); // debug log of the load
+    assert(loaded.size() == 2 && loaded["a"].getValue() == 0.1f && loaded["a"].getLower() == -1e-7f && loaded["a"].isClips());
+    assert(loaded["b"].isConstant() && loaded["b"].getStep() == 0.5f && isinf(loaded["b"].getLower()));
+    assert(values.getAsIniData().get<float>("lower", "a") == -1e-7f && "IniData keeps the precision too");
+    unlink(filename);
+}
+
 #endif
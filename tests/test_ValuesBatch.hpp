@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../TEST.hpp"
+#include "../ValuesBatch.hpp"
+
+#ifdef TEST
+
+#include "../str_contains.hpp"
+
+static Values test_ValuesBatch_values() {
+    Values values;
+    values.push_back(Value(0.0f, "x", -10.0f, 10.0f, 0.5f));
+    values.push_back(Value(7.0f, "k", 0.0f, 10.0f, NAN, true)); // constant
+    values.push_back(Value(0.0f, "y", -1.0f, 1.0f, NAN, false, false, true)); // clips
+    return values;
+}
+
+TEST(test_ValuesBatch_results_in_population_order) {
+    Values values = test_ValuesBatch_values();
+    Values::Handle y = values.handle("y");
+    ValuesBatch batch(values, 4);
+    assert(batch.getThreads() == 4);
+    vector<vector<float>> population;
+    for (int i = 0; i < 200; i++) population.push_back({ (float)(i % 20) - 9.8f, 5.0f });
+    vector<ValuesBatchResult> results = batch.evaluate(population, [&](const ValuesView& v) {
+        // later candidates finish first
+        this_thread::sleep_for(chrono::microseconds((int)(10 - v.get("x")) * 20));
+        return v.get("x") * 100 + v[y] + v.get("k") / 1000;
+    });
+    assert(results.size() == 200);
+    for (size_t i = 0; i < results.size(); i++) {
+        float x = ::round(((float)(i % 20) - 9.8f) / 0.5f) * 0.5f;
+        assert(results[i].candidate == i && results[i].error.empty());
+        assert(abs(results[i].score - (x * 100 + 1 + 0.007)) < 1e-4 && "x is snapped to the step, y is clipped, k stays");
+        assert(results[i].ms >= 0);
+    }
+    assert(values.get<float>("x") == 0.0f && values.get<float>("y") == 0.0f && "the values are not written");
+}
+
+TEST(test_ValuesBatch_errors_per_candidate) {
+    Values values = test_ValuesBatch_values();
+    ValuesBatch batch(values, 2);
+    vector<vector<float>> population = { { 1.0f, 0.0f }, { 20.0f, 0.0f }, { 2.0f, 0.0f }, { 1.0f }, { 3.0f, 0.0f } };
+    vector<ValuesBatchResult> results = batch.evaluate(population, [](const ValuesView& v) {
+        if (v.get("x") == 2.0f) throw ERROR("objective failed");
+        if (v.get("x") == 3.0f) throw 3; // not an std::exception
+        return (double)v.get("x");
+    });
+    assert(results[0].error.empty() && results[0].score == 1.0);
+    assert(str_contains(results[1].error, "Out of bounds: x"));
+    assert(str_contains(results[2].error, "objective failed"));
+    assert(str_contains(results[3].error, "Values size mismatch, 1 != 2"));
+    assert(results[4].error == "unknown exception");
+
+    // the pool keeps working after failures and between batches
+    for (int round = 0; round < 20; round++) {
+        results = batch.evaluate({ { 3.0f, 0.5f } }, [](const ValuesView& v) { return v.get("x") + v.get("y"); });
+        assert(results.size() == 1 && results[0].score == 3.5);
+    }
+    assert(batch.evaluate({}, [](const ValuesView&) { return 0.0; }).empty());
+}
+
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "../TEST.hpp"
+#include "../Values.hpp"
+
+#ifdef TEST
+
+#include "../str_contains.hpp"
+
+// Constant, continuous, clipped, discrete and rounded values mixed
+Values test_ValuesBlock_values() {
+    Values values;
+    values.push_back(Value(1.0f, "const", 0.0f, 10.0f, NAN, true));
+    values.push_back(Value(2.0f, "free"));
+    values.push_back(Value(3.0f, "clipped", 0.0f, 5.0f, NAN, false, false, true));
+    values.push_back(Value(4.0f, "discrete", 1.0f, 9.0f, 0.5f, false, false, true));
+    values.push_back(Value(5.0f, "rounded", -10.0f, 10.0f, NAN, false, true, true));
+    values.push_back(Value(6.0f, "loose", 0.0f, 10.0f, NAN, false, false, false, false));
+    return values;
+}
+
+TEST(test_ValuesBlock_matches_values) {
+    Values values = test_ValuesBlock_values();
+    ValuesBlock block = values.getBlock();
+    assert(block.getVariablesSize() == 5);
+    assert(block.getVariables() == values.getVariables());
+    assert(block.getLowerBounds() == values.getLowerBounds());
+    assert(block.getUpperBounds() == values.getUpperBounds());
+    for (vector<float> x: vector<vector<float>>{
+        { 1.5f, -7.0f, 4.26f, 2.4f, 20.0f },
+        { -3.0f, 9.0f, 8.74f, -1.5f, 11.0f },
+        { 0.0f, 2.5f, 1.26f, 3.5f, -0.5f },
+    }) {
+        values.setVariables(x);
+        block.setVariables(x);
+        assert(block.getVariables() == values.getVariables());
+        for (size_t i = 0; i < values.size(); i++) assert(block[i].getValue() == values[i].getValue());
+    }
+    Values back;
+    back.setBlock(block);
+    assert(back.size() == values.size());
+    assert(back["discrete"].getStep() == 0.5f && back["const"].isConstant());
+    assert(back.getVariables() == values.getVariables());
+}
+
+TEST(test_ValuesBlock_errors) {
+    ValuesBlock block = test_ValuesBlock_values().getBlock();
+    string error;
+    try {
+        block.setVariables(vector<float>{ 1.0f });
+    } catch (const exception& e) {
+        error = e.what();
+    }
+    assert(str_contains(error, "Values size mismatch, 1 != 5"));
+    error = "";
+    try {
+        block[0] = 2.0f;
+    } catch (const exception& e) {
+        error = e.what();
+    }
+    assert(str_contains(error, "Cannot assign to constant"));
+    error = "";
+    try {
+        block[1].setBounds(0.0f, 1.0f);
+        block.setVariables(vector<float>{ 5.0f, 1.0f, 1.0f, 1.0f, 1.0f });
+    } catch (const exception& e) {
+        error = e.what();
+    }
+    assert(str_contains(error, "Out of bounds"));
+}
+
+TEST(test_ValuesBlock_proxy_updates_variables) {
+    ValuesBlock block = test_ValuesBlock_values().getBlock();
+    block[1] = 7.0f;
+    assert(block[1] == 7.0f && block.getVariables()[0] == 7.0f);
+    block[0].setConstant(false);
+    block[1].setConstant(true);
+    assert(block.getVariablesSize() == 5 && block.getLowerBounds()[0] == 0.0f);
+    block[2].setUpper(2.0f);
+    assert(block[2] == 2.0f && "clipped into the new bound");
+    assert(block.getUpperBounds()[1] == 2.0f);
+}
+
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "../TEST.hpp"
+#include "../coarse_get_time_ms.hpp"
+#include "../get_time_ms.hpp"
+
+#include <thread>
+#include <chrono>
+
+#ifdef TEST
+
+TEST(test_coarse_get_time_ms_close_to_default) {
+    time_ms coarse = coarse_get_time_ms();
+    time_ms exact = default_get_time_ms();
+    time_ms diff = exact > coarse ? exact - coarse : coarse - exact;
+    assert(diff < 100 && "coarse_get_time_ms should be close to the current time");
+}
+
+TEST(test_coarse_get_time_ms_ticks) {
+    time_ms t1 = coarse_get_time_ms();
+    this_thread::sleep_for(chrono::milliseconds(50));
+    time_ms t2 = coarse_get_time_ms();
+    assert(t2 > t1 && "coarse_get_time_ms should be refreshed in the background");
+}
+
+TEST(test_coarse_get_time_ms_as_hook) {
+    auto original_get_time_ms = get_time_ms;
+    get_time_ms = coarse_get_time_ms;
+    time_ms ms = get_time_ms();
+    get_time_ms = original_get_time_ms;
+    time_ms diff = default_get_time_ms() - ms;
+    assert(diff >= 0 && diff < 100);
+}
+
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "../TEST.hpp"
+#include "../crc32c.hpp"
+
+#ifdef TEST
+
+TEST(test_crc32c_check_value) {
+    assert(crc32c("123456789", 9) == 0xE3069283 && "CRC-32C check value");
+    assert(crc32c("", 0) == 0);
+}
+
+TEST(test_crc32c_kernels_match) {
+    vector<Crc32cKernel> kernels = { CRC32C_KERNEL_SOFTWARE };
+#ifdef CRC32C_X86
+    if (__builtin_cpu_supports("sse4.2")) kernels.push_back(CRC32C_KERNEL_SSE42);
+    assert(kernels.back() == crc32c_kernel() && "the crc32 instruction has to run on x86");
+#endif
+    string data;
+    for (int i = 0; i < 1000; i++) data += (char)(i * 37 + i / 5);
+    for (Crc32cKernel kernel: kernels) {
+        assert(crc32c("123456789", 9, 0, kernel) == 0xE3069283);
+        for (size_t size: { 0, 1, 7, 8, 9, 63, 1000 })
+            assert(crc32c(data.data(), size, 0, kernel) == crc32c(data.data(), size, 0, CRC32C_KERNEL_SOFTWARE));
+        assert(crc32c(data.data() + 3, 500, 0x12345678, kernel) == crc32c(data.data() + 3, 500, 0x12345678, CRC32C_KERNEL_SOFTWARE));
+    }
+}
+
+TEST(test_crc32c_continues) {
+    string data;
+    for (int i = 0; i < 1000; i++) data += (char)(i * 31);
+    uint32_t whole = crc32c(data.data(), data.size());
+    for (size_t split: { 0, 1, 7, 8, 13, 500, 1000 })
+        assert(crc32c(data.data() + split, data.size() - split, crc32c(data.data(), split)) == whole);
+}
+
+#endif
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "../TEST.hpp"
+#include "../json_parse_fast.hpp"
+
+#ifdef TEST
+
+#include "../str_contains.hpp"
+
+void test_json_parse_fast_same(const string& jstring) {
+    nlohmann::json expected = nlohmann::json::parse(jstring);
+    nlohmann::json actual = json_parse_fast(jstring);
+    assert(actual == expected && actual.dump() == expected.dump());
+}
+
+string test_json_parse_fast_error(const string& jstring) {
+    try {
+        json_parse_fast(jstring);
+    } catch (const exception& e) {
+        return e.what();
+    }
+    return "";
+}
+
+TEST(test_json_parse_fast_same_as_nlohmann) {
+    test_json_parse_fast_same("{}");
+    test_json_parse_fast_same("[]");
+    test_json_parse_fast_same("  42  ");
+    test_json_parse_fast_same("\"text\"");
+    test_json_parse_fast_same("{\"a\": [1, -2, 3.5, -0.25e-3, 1E10, true, false, null], \"b\": {\"c\": \"d\"}}");
+    test_json_parse_fast_same("{\"dup\": 1, \"dup\": 2}");
+    test_json_parse_fast_same("[18446744073709551615, -9223372036854775808, 18446744073709551616, 1e-400]");
+    test_json_parse_fast_same("[\"esc \\\" \\\\ \\/ \\b \\f \\n \\r \\t\", \"\\u00e9\\u20ac\\ud83d\\ude00\", \"\xc3\xa9\"]");
+}
+
+TEST(test_json_parse_fast_number_types) {
+    nlohmann::json j = json_parse_fast("[1, -1, 1.0, 99999999999999999999]");
+    assert(j[0].is_number_unsigned());
+    assert(j[1].is_number_integer() && !j[1].is_number_unsigned());
+    assert(j[2].is_number_float());
+    assert(j[3].is_number_float());
+}
+
+TEST(test_json_parse_fast_comments_and_trailing_commas) {
+    string jstring =
+        "// leading comment\n"
+        "{\n"
+        "    \"a\": 1, /* inline */\n"
+        "    \"url\": \"http://not/*a*/comment\",\n"
+        "    \"list\": [1, 2, 3,],\n"
+        "    \"empty\": [,],\n"
+        "    \"obj\": {\"x\": \"y\", // trailing\n"
+        "    },\n"
+        "}\n"
+        "/* end */";
+    nlohmann::json j = json_parse_fast(jstring);
+    assert(j == nlohmann::json::parse(json_fix(jstring)));
+    assert(j["url"] == "http://not/*a*/comment");
+    assert(j["list"].size() == 3);
+    assert(j["empty"].empty());
+}
+
+TEST(test_json_parse_fast_block_boundaries) {
+    // strings, escapes and whitespace crossing the 64 byte mask blocks
+    for (size_t pad = 0; pad < 130; pad++) {
+        string jstring = "{" + string(pad, ' ') + "\"k\": \"" + string(pad, 'x') + "\\n\\u00e9" + string(pad % 7, '\t') + "\"}";
+        // raw tabs are invalid inside strings
+        if (pad % 7) assert(str_contains(test_json_parse_fast_error(jstring), "Control character"));
+        jstring = "{" + string(pad, ' ') + "\"k\": \"" + string(pad, 'x') + "\\n\\u00e9\", \"n\": " + to_string(pad) + "}";
+        test_json_parse_fast_same(jstring);
+    }
+}
+
+TEST(test_json_parse_fast_simd_index_matches_scalar) {
+    string data;
+    for (int i = 0; i < 1000; i++) data += (char)((i * 37 + i / 3) % 256);
+    JSONStructuralIndex scalar = json_structural_index(data.data(), data.size(), false);
+    vector<JSONIndexKernel> kernels;
+#ifdef JSON_INDEX_X86
+    if (__builtin_cpu_supports("avx2")) kernels.push_back(JSON_INDEX_AVX2);
+    if (__builtin_cpu_supports("sse2")) kernels.push_back(JSON_INDEX_SSE2);
+    assert(!kernels.empty() && kernels[0] == json_index_kernel() && "the SIMD kernels have to run on x86");
+#endif
+    for (JSONIndexKernel kernel: kernels) {
+        JSONStructuralIndex simd = json_structural_index(data.data(), data.size(), kernel);
+        assert(simd.nonws == scalar.nonws);
+        assert(simd.special == scalar.special);
+        assert(simd.nonascii == scalar.nonascii);
+    }
+}
+
+TEST(test_json_parse_fast_errors) {
+    assert(str_contains(test_json_parse_fast_error("{\"a\": }"), "Invalid number"));
+    assert(str_contains(test_json_parse_fast_error("{\"a\" 1}"), "Expected ':'"));
+    assert(str_contains(test_json_parse_fast_error("[1 2]"), "Expected ',' or ']'"));
+    assert(str_contains(test_json_parse_fast_error("[1,,]"), "Invalid number"));
+    assert(str_contains(test_json_parse_fast_error("[,1]"), "Unexpected ','"));
+    assert(str_contains(test_json_parse_fast_error("\"open"), "Unterminated string"));
+    assert(str_contains(test_json_parse_fast_error("[1] x"), "Unexpected trailing characters"));
+    assert(str_contains(test_json_parse_fast_error("01"), "Unexpected trailing characters"));
+    assert(str_contains(test_json_parse_fast_error("[tru]"), "Invalid literal"));
+    assert(str_contains(test_json_parse_fast_error("\"\\x\""), "Invalid escape"));
+    assert(str_contains(test_json_parse_fast_error("\"\\ud800\""), "Unpaired surrogate"));
+    assert(str_contains(test_json_parse_fast_error("\"\xc3\""), "Invalid UTF-8"));
+    assert(str_contains(test_json_parse_fast_error("[1e999]"), "Number out of range"));
+    assert(str_contains(test_json_parse_fast_error("/* open"), "Unterminated comment"));
+    assert(str_contains(test_json_parse_fast_error(string(2000, '[')), "Nesting too deep"));
+}
+
+TEST(test_json_parse_fast_as_json_parser) {
+    nlohmann::json (*prev)(const string&) = json_parse;
+    json_parse = json_parse_fast;
+    JSON json("{\"a\": {\"b\": [1, 2, 3,]}, // comment\n}");
+    JSON broken("{\"a\": ");
+    json_parse = prev;
+    assert(json.isValid());
+    assert(json.get<int>(".a.b[2]") == 3);
+    assert(!broken.isValid());
+}
+
+#endif
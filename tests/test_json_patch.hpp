@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../TEST.hpp"
+#include "../JSON.hpp"
+
+#ifdef TEST
+
+// json_diff() output has to turn source into target
+void test_json_patch_roundtrip(const string& source, const string& target, size_t expected_ops = string::npos) {
+    nlohmann::json a = nlohmann::json::parse(source);
+    nlohmann::json b = nlohmann::json::parse(target);
+    nlohmann::json ops = json_diff(a, b);
+    assert(a.patch(ops) == b);
+    if (expected_ops != string::npos) assert(ops.size() == expected_ops);
+}
+
+TEST(test_json_diff_objects) {
+    test_json_patch_roundtrip(R"({"a": 1, "b": {"c": 2, "d": 3}})", R"({"a": 1, "b": {"c": 4}, "e": 5})", 3);
+    test_json_patch_roundtrip(R"({"a/b": 1, "m~n": 2})", R"({"a/b": 2})", 2);
+    test_json_patch_roundtrip(R"({"a": 1})", R"({"a": 1})", 0);
+    test_json_patch_roundtrip(R"({"a": {"b": 1}})", R"({"a": [1]})", 1);
+    test_json_patch_roundtrip(R"(1)", R"("x")", 1);
+}
+
+TEST(test_json_diff_arrays) {
+    test_json_patch_roundtrip("[1, 2, 3, 4, 5]", "[1, 2, 9, 3, 4, 5]", 1);
+    test_json_patch_roundtrip("[1, 2, 3, 4, 5]", "[1, 3, 4, 5]", 1);
+    test_json_patch_roundtrip("[1, 2, 3, 4, 5]", "[0, 1, 2, 3, 4, 5]", 1);
+    test_json_patch_roundtrip("[1, 2, 3, 4, 5]", "[1, 7, 8, 5]", 3);
+    test_json_patch_roundtrip("[1, 2, 3]", "[]", 3);
+    test_json_patch_roundtrip("[]", "[1, 2, 3]", 3);
+    test_json_patch_roundtrip(R"([{"a": 1}, {"a": 2}])", R"([{"a": 1}, {"a": 3, "b": 4}])", 2);
+}
+
+TEST(test_JSON_patch_in_place) {
+    JSON json(R"({"list": [1, 2], "name": "x"})");
+    JSON target(R"({"list": [1, 2, 3], "name": "y"})");
+    nlohmann::json ops = json.diff(target);
+    size_t version = json.version();
+    json.patch(ops);
+    assert(json.get_json_cref() == target.get_json_cref());
+    assert(json.version() != version);
+    json.merge_patch(nlohmann::json::parse(R"({"name": null, "extra": {"on": true}})"));
+    assert(!json.has(".name") && json.get<bool>(".extra.on"));
+    bool thrown = false;
+    try {
+        json.patch(nlohmann::json::parse(R"([{"op": "remove", "path": "/missing"}])"));
+    } catch (const exception& e) {
+        thrown = string(e.what()).find("JSON patch failed") != string::npos;
+    }
+    assert(thrown);
+}
+
+#endif
@@ -37,4 +37,19 @@ TEST(test_ms_to_datetime) {
     get_time_ms = original_get_time_ms;
 }
 
+TEST(test_ms_to_datetime_cached_matches_render) {
+    time_ms start = 1696516245900LL;
+    for (time_ms ms = start; ms < start + 2500; ms += 37) {
+        assert(ms_to_datetime(ms) == ms_to_datetime_render(ms));
+        assert(ms_to_datetime(ms, "%H:%M:%S", false) == ms_to_datetime_render(ms, "%H:%M:%S", false));
+        assert(ms_to_datetime(ms, "%Y-%m-%d %H:%M:%S", true, true) == ms_to_datetime_render(ms, "%Y-%m-%d %H:%M:%S", true, true));
+    }
+}
+
+TEST(test_ms_to_datetime_cached_millis_padding) {
+    assert(ms_to_datetime(1696516245007LL) == "2023-10-05 14:30:45.007");
+    assert(ms_to_datetime(1696516245070LL) == "2023-10-05 14:30:45.070");
+    assert(ms_to_datetime(1696516245000LL) == "2023-10-05 14:30:45.000");
+}
+
 #endif
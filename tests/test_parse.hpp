@@ -56,13 +56,23 @@ TEST(test_parse_whitespace_only) {
 }
 
 TEST(test_parse_trailing_characters) {    
-    int actual = parse<int>("42abc");
-    assert(actual == 42 && "test_parse_trailing_characters failed");
+    bool thrown = false;
+    try {
+        parse<int>("42abc");
+    } catch (const exception&) {
+        thrown = true;
+    }
+    assert(thrown && "test_parse_trailing_characters failed, the whole string is a number or an error");
 }
 
 TEST(test_parse_trailing_characters_negative) {    
-    int actual = parse<int>("-42abc");
-    assert(actual == -42 && "test_parse_trailing_characters_negative failed");
+    bool thrown = false;
+    try {
+        parse<int>("-42abc");
+    } catch (const exception&) {
+        thrown = true;
+    }
+    assert(thrown && "test_parse_trailing_characters_negative failed");
 }
 
 TEST(test_parse_floating_point_with_exponent) {
@@ -143,4 +153,49 @@ TEST(test_parse_nan_invalid_int) {
     assert(thrown && "test_parse_nan_invalid_int failed");
 }
 
+TEST(test_parse_surrounding_whitespace_and_plus) {
+    assert(parse<int>("  42\t") == 42);
+    assert(parse<double>(" +2.5 ") == 2.5);
+    assert(parse<unsigned>("+7") == 7u);
+    assert(isinf(parse<double>("-INF")) && isnan(parse<float>("NaN")));
+    bool thrown = false;
+    try {
+        parse<int>("+-1");
+    } catch (const exception&) {
+        thrown = true;
+    }
+    assert(thrown && "only one sign");
+}
+
+TEST(test_parse_out_of_range) {
+    bool thrown = false;
+    try {
+        parse<int8_t>("300");
+    } catch (const exception& e) {
+        thrown = string(e.what()).find("not a number") != string::npos;
+    }
+    assert(thrown && "overflow is an error");
+    thrown = false;
+    try {
+        parse<unsigned>("-1");
+    } catch (const exception&) {
+        thrown = true;
+    }
+    assert(thrown && "no wrap around for unsigned");
+}
+
+TEST(test_parse_string_view) {
+    string_view line = "x=12.5;";
+    assert(parse<float>(line.substr(2, 4)) == 12.5f && "parses a slice, no copy");
+    assert(parse<string>(line.substr(0, 1)) == "x");
+    assert(parse<bool>(string_view("Yes")) && !parse<bool>("OFF"));
+    bool thrown = false;
+    try {
+        parse<bool>("maybe");
+    } catch (const exception& e) {
+        thrown = string(e.what()).find("not a boolean") != string::npos;
+    }
+    assert(thrown);
+}
+
 #endif
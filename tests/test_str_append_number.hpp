@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../TEST.hpp"
+#include "../str_append_number.hpp"
+
+#ifdef TEST
+
+#include "../parse.hpp"
+#include <cmath>
+#include <limits>
+
+TEST(test_str_append_number_shortest_roundtrip) {
+    assert(str_number(0.1f) == "0.1" && str_number(1e-7f) == "1e-07");
+    assert(str_number(5.0) == "5" && str_number(-42) == "-42" && str_number(true) == "1");
+    for (float f: { 0.1f, 1.0f / 3.0f, 123456.789f, -1e-30f, numeric_limits<float>::max(), numeric_limits<float>::denorm_min() })
+        assert(parse<float>(str_number(f)) == f && "parses back to the same float");
+    for (double d: { 0.1, 2.0 / 3.0, 1e300, -5e-324 })
+        assert(parse<double>(str_number(d)) == d);
+    assert(str_number(INFINITY) == "inf" && str_number(-INFINITY) == "-inf" && isnan(parse<float>(str_number(NAN))));
+}
+
+TEST(test_str_append_number_appends) {
+    string out = "x=";
+    size_t capacity = (out.reserve(64), out.capacity());
+    str_append_number(out, 1.5f);
+    out += ',';
+    str_append_number(out, (long long)-9);
+    assert(out == "x=1.5,-9" && out.capacity() == capacity);
+}
+
+#endif
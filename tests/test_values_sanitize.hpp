@@ -0,0 +1,82 @@
+#pragma once
+
+#include "../TEST.hpp"
+#include "../values_sanitize.hpp"
+#include "../Values.hpp"
+
+#ifdef TEST
+
+#include "../str_contains.hpp"
+#include <random>
+
+// Every kernel the CPU runs, scalar and ValueT assignment have to agree bit for bit
+TEST(test_values_sanitize_matches_ValueT) {
+    mt19937 rng(42);
+    uniform_real_distribution<float> any(-50.0f, 50.0f);
+    size_t n = 1003; // not a multiple of the lanes
+    vector<float> v(n), lower(n), upper(n), step(n);
+    vector<uint8_t> flags(n);
+    for (size_t i = 0; i < n; i++) {
+        lower[i] = any(rng) / 2 - 10;
+        upper[i] = lower[i] + fabs(any(rng));
+        step[i] = i % 3 == 0 ? 0.25f * (1 + i % 5) : NAN;
+        flags[i] = rng() % 8;
+        v[i] = i % 17 == 0 ? lower[i] + 0.5f : any(rng); // some exact halves for round()
+    }
+    vector<float> scalar = v;
+    vector<size_t> scalar_bad;
+    size_t count = values_sanitize(scalar.data(), n, lower.data(), upper.data(), step.data(), flags.data(), &scalar_bad, false);
+    assert(count == scalar_bad.size() && count > 0);
+
+    vector<ValuesSanitizeKernel> kernels;
+#ifdef VALUES_SANITIZE_X86
+    if (__builtin_cpu_supports("avx2")) kernels.push_back(VALUES_KERNEL_AVX2);
+    if (__builtin_cpu_supports("sse4.1")) kernels.push_back(VALUES_KERNEL_SSE41);
+    assert((kernels.empty() ? VALUES_KERNEL_SCALAR : kernels[0]) == values_sanitize_kernel());
+#endif
+    for (ValuesSanitizeKernel kernel: kernels) {
+        vector<float> simd = v;
+        vector<size_t> simd_bad;
+        assert(values_sanitize(simd.data(), n, lower.data(), upper.data(), step.data(), flags.data(), &simd_bad, kernel) == count);
+        assert(simd_bad == scalar_bad);
+        for (size_t i = 0; i < n; i++)
+            assert(memcmp(&simd[i], &scalar[i], sizeof(float)) == 0);
+    }
+#ifdef VALUES_SANITIZE_X86
+    assert((!kernels.empty() || !__builtin_cpu_supports("sse4.1")) && "the SIMD kernels have to run on x86");
+#endif
+
+    for (size_t i = 0; i < n; i++) {
+        Value value(0.0f, "", lower[i], upper[i], step[i], false, flags[i] & VALUES_ROUNDED, flags[i] & VALUES_CLIPS, false);
+        value = v[i];
+        assert(value.getValue() == scalar[i]);
+    }
+}
+
+TEST(test_values_sanitize_rounds_halves_away_from_zero) {
+    vector<float> v = { 0.5f, -0.5f, 1.5f, 2.5f, -2.5f, 0.49999997f, 8388609.0f, -0.3f };
+    vector<float> lower(v.size(), -INFINITY), upper(v.size(), INFINITY), step(v.size(), NAN);
+    vector<uint8_t> flags(v.size(), VALUES_ROUNDED);
+    for (ValuesSanitizeKernel kernel: { VALUES_KERNEL_SCALAR, values_sanitize_kernel() }) {
+        vector<float> w = v;
+        values_sanitize(w.data(), w.size(), lower.data(), upper.data(), step.data(), flags.data(), nullptr, kernel);
+        assert((w == vector<float>{ 1.0f, -1.0f, 2.0f, 3.0f, -3.0f, 0.0f, 8388609.0f, -0.0f }));
+    }
+}
+
+TEST(test_Values_setVariables_reports_all_violations) {
+    Values values;
+    values.push_back(Value(0.0f, "a", 0.0f, 1.0f));
+    values.push_back(Value(0.0f, "b", 0.0f, 1.0f, NAN, false, false, true));
+    values.push_back(Value(0.0f, "c", 0.0f, 1.0f));
+    string error;
+    try {
+        values.setVariables({ 2.0f, 2.0f, -1.0f });
+    } catch (const exception& e) {
+        error = e.what();
+    }
+    assert(str_contains(error, "Out of bounds: a, c"));
+    assert(values["b"] == 1.0f && "the clipping value is still fixed");
+}
+
+#endif
@@ -16,7 +16,11 @@
 #include "test_Builder.hpp"
 #include "test_capture_cerr.hpp"
 #include "test_capture_cout_cerr.hpp"
+#include "test_coarse_get_time_ms.hpp"
+#include "test_Columnar.hpp"
 #include "test_compare_diff_vectors.hpp"
+#include "test_ConfigSchema.hpp"
+#include "test_crc32c.hpp"
 #include "test_datetime_to_ms.hpp"
 #include "test_datetime_to_sec.hpp"
 #include "test_date_to_ms.hpp"
@@ -24,6 +28,7 @@
 #include "test_execute.hpp"
 #include "test_Executor.hpp"
 #include "test_explode.hpp"
+#include "test_FileLogger.hpp"
 #include "test_fix_path.hpp"
 #include "test_foreach.hpp"
 #include "test_get_absolute_path.hpp"
@@ -36,6 +41,14 @@
 #include "test_is_valid_datetime.hpp"
 #include "test_JSON.hpp"
 #include "test_JSONExts.hpp"
+#include "test_JSONLazy.hpp"
+#include "test_JSONWatcher.hpp"
+#include "test_json_parse_fast.hpp"
+#include "test_json_patch.hpp"
+#include "test_JSONStream.hpp"
+#include "test_Logger.hpp"
+#include "test_MappedVector.hpp"
+#include "test_Metrics.hpp"
 #include "test_ms_to_datetime.hpp"
 #include "test_parse.hpp"
 #include "test_readdir.hpp"
@@ -48,12 +61,14 @@
 #include "test_rsort.hpp"
 #include "test_sec_to_datetime.hpp"
 #include "test_Serializable_vector_serialize.hpp"
+#include "test_SerialWriter.hpp"
 #include "test_Settings.hpp"
 #include "test_ShorthandGenerator.hpp"
 #include "test_sort.hpp"
 #include "test_Stopper.hpp"
 #include "test_strtolower.hpp"
 #include "test_strtoupper.hpp"
+#include "test_str_append_number.hpp"
 #include "test_str_cut_begin.hpp"
 #include "test_str_cut_end.hpp"
 #include "test_str_diffs_show.hpp"
@@ -63,12 +78,16 @@
 #include "test_str_replace.hpp"
 #include "test_str_serialize.hpp"
 #include "test_str_starts_with.hpp"
+#include "test_TeeLogger.hpp"
 #include "test_to_milliseconds.hpp"
 #include "test_to_seconds.hpp"
 #include "test_tpl_replace.hpp"
 #include "test_trim.hpp"
 #include "test_Value.hpp"
 #include "test_Values.hpp"
+#include "test_values_sanitize.hpp"
+#include "test_ValuesBatch.hpp"
+#include "test_ValuesBlock.hpp"
 #include "test_vector_concat.hpp"
 #include "test_vector_equal.hpp"
 #include "test_vector_load.hpp"
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define VALUES_SANITIZE_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// Per value rule flags for values_sanitize()
+enum ValuesSanitizeFlag: uint8_t {
+    VALUES_ROUNDED = 1,
+    VALUES_CLIPS = 2,
+    VALUES_THROWS = 4,
+};
+
+// One value, the same steps as ValueT::fix(): discretize (step > 0, NaN is
+// continuous), round, clip, then false when a throwing value is out of bounds
+template<typename real>
+inline bool values_sanitize_scalar(real& v, real lower, real upper, real step, uint8_t flags) {
+    if (step > 0) {
+        real steps = ::round((v - lower) / step);
+        v = lower + steps * step;
+    }
+    if (flags & VALUES_ROUNDED) v = ::round(v);
+    if (flags & VALUES_CLIPS) {
+        if (v < lower) v = lower;
+        if (v > upper) v = upper;
+    }
+    return !((flags & VALUES_THROWS) && (v < lower || v > upper));
+}
+
+// Kernels values_sanitize() can run, the widest one the CPU supports is picked
+enum ValuesSanitizeKernel: uint8_t {
+    VALUES_KERNEL_SCALAR = 0,
+    VALUES_KERNEL_SSE41,
+    VALUES_KERNEL_AVX2,
+};
+
+#ifdef VALUES_SANITIZE_X86
+
+// The kernels are compiled for their instruction set whatever the build
+// flags are, values_sanitize_kernel() checks the CPU before they are called
+
+// ::round() (halves away from zero): x - trunc(x) is exact, so compare it to 0.5
+__attribute__((target("avx2")))
+inline __m256 values_round_avx2(__m256 x) {
+    const __m256 half = _mm256_set1_ps(0.5f), one = _mm256_set1_ps(1.0f), sign = _mm256_set1_ps(-0.0f);
+    __m256 t = _mm256_round_ps(x, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __m256 away = _mm256_cmp_ps(_mm256_andnot_ps(sign, _mm256_sub_ps(x, t)), half, _CMP_GE_OQ);
+    __m256 unit = _mm256_or_ps(_mm256_and_ps(x, sign), one);
+    return _mm256_blendv_ps(t, _mm256_add_ps(t, unit), away); // t + 0 would turn -0 into 0
+}
+
+__attribute__((target("avx2")))
+inline __m256 values_flag_avx2(__m256i flags, int bit) {
+    return _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_and_si256(flags, _mm256_set1_epi32(bit)), _mm256_setzero_si256()));
+}
+
+// 8 values at a time while they last, returns how many values were done
+__attribute__((target("avx2")))
+inline size_t values_sanitize_avx2(float* v, size_t size, const float* lower, const float* upper, const float* step, const uint8_t* flags, vector<size_t>* violations, size_t& count) {
+    const __m256 zero = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        __m256 x = _mm256_loadu_ps(v + i), lo = _mm256_loadu_ps(lower + i), hi = _mm256_loadu_ps(upper + i), st = _mm256_loadu_ps(step + i);
+        __m256i f = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(flags + i)));
+        __m256 snapped = _mm256_add_ps(lo, _mm256_mul_ps(values_round_avx2(_mm256_div_ps(_mm256_sub_ps(x, lo), st)), st));
+        x = _mm256_blendv_ps(x, snapped, _mm256_cmp_ps(st, zero, _CMP_GT_OQ));
+        x = _mm256_blendv_ps(x, values_round_avx2(x), values_flag_avx2(f, VALUES_ROUNDED));
+        __m256 clips = values_flag_avx2(f, VALUES_CLIPS);
+        x = _mm256_blendv_ps(x, lo, _mm256_and_ps(clips, _mm256_cmp_ps(x, lo, _CMP_LT_OQ)));
+        x = _mm256_blendv_ps(x, hi, _mm256_and_ps(clips, _mm256_cmp_ps(x, hi, _CMP_GT_OQ)));
+        __m256 outside = _mm256_or_ps(_mm256_cmp_ps(x, lo, _CMP_LT_OQ), _mm256_cmp_ps(x, hi, _CMP_GT_OQ));
+        _mm256_storeu_ps(v + i, x);
+        int bad = _mm256_movemask_ps(_mm256_and_ps(outside, values_flag_avx2(f, VALUES_THROWS)));
+        for (int lane = 0; bad && lane < 8; lane++)
+            if (bad & (1 << lane)) {
+                count++;
+                if (violations) violations->push_back(i + lane);
+            }
+    }
+    return i;
+}
+
+__attribute__((target("sse4.1")))
+inline __m128 values_round_sse41(__m128 x) {
+    const __m128 half = _mm_set1_ps(0.5f), one = _mm_set1_ps(1.0f), sign = _mm_set1_ps(-0.0f);
+    __m128 t = _mm_round_ps(x, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __m128 away = _mm_cmpge_ps(_mm_andnot_ps(sign, _mm_sub_ps(x, t)), half);
+    __m128 unit = _mm_or_ps(_mm_and_ps(x, sign), one);
+    return _mm_blendv_ps(t, _mm_add_ps(t, unit), away);
+}
+
+__attribute__((target("sse4.1")))
+inline __m128 values_flag_sse41(__m128i flags, int bit) {
+    return _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_and_si128(flags, _mm_set1_epi32(bit)), _mm_setzero_si128()));
+}
+
+__attribute__((target("sse4.1")))
+inline size_t values_sanitize_sse41(float* v, size_t size, const float* lower, const float* upper, const float* step, const uint8_t* flags, vector<size_t>* violations, size_t& count) {
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m128 x = _mm_loadu_ps(v + i), lo = _mm_loadu_ps(lower + i), hi = _mm_loadu_ps(upper + i), st = _mm_loadu_ps(step + i);
+        int32_t packed;
+        memcpy(&packed, flags + i, sizeof(packed));
+        __m128i f = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed));
+        __m128 snapped = _mm_add_ps(lo, _mm_mul_ps(values_round_sse41(_mm_div_ps(_mm_sub_ps(x, lo), st)), st));
+        x = _mm_blendv_ps(x, snapped, _mm_cmpgt_ps(st, _mm_setzero_ps()));
+        x = _mm_blendv_ps(x, values_round_sse41(x), values_flag_sse41(f, VALUES_ROUNDED));
+        __m128 clips = values_flag_sse41(f, VALUES_CLIPS);
+        x = _mm_blendv_ps(x, lo, _mm_and_ps(clips, _mm_cmplt_ps(x, lo)));
+        x = _mm_blendv_ps(x, hi, _mm_and_ps(clips, _mm_cmpgt_ps(x, hi)));
+        __m128 outside = _mm_or_ps(_mm_cmplt_ps(x, lo), _mm_cmpgt_ps(x, hi));
+        _mm_storeu_ps(v + i, x);
+        int bad = _mm_movemask_ps(_mm_and_ps(outside, values_flag_sse41(f, VALUES_THROWS)));
+        for (int lane = 0; bad && lane < 4; lane++)
+            if (bad & (1 << lane)) {
+                count++;
+                if (violations) violations->push_back(i + lane);
+            }
+    }
+    return i;
+}
+
+#endif
+
+// Widest kernel this CPU runs, checked once
+inline ValuesSanitizeKernel values_sanitize_kernel() {
+#ifdef VALUES_SANITIZE_X86
+    static const ValuesSanitizeKernel kernel =
+        __builtin_cpu_supports("avx2") ? VALUES_KERNEL_AVX2 :
+        __builtin_cpu_supports("sse4.1") ? VALUES_KERNEL_SSE41 : VALUES_KERNEL_SCALAR;
+    return kernel;
+#else
+    return VALUES_KERNEL_SCALAR;
+#endif
+}
+
+// Sanitizes v[0, size) against per value bounds, steps and flags in one pass
+// with the given kernel (float only, others run scalar) and returns the number
+// of violations: throwing values left out of bounds. Their indexes are
+// appended to violations when given. Unlike assigning ValueT by ValueT nothing
+// stops at the first violation, every value is fixed and every violation reported.
+// The kernel has to be one the CPU supports, see values_sanitize_kernel().
+template<typename real>
+size_t values_sanitize(
+    real* v, size_t size,
+    const real* lower, const real* upper, const real* step, const uint8_t* flags,
+    vector<size_t>* violations,
+    ValuesSanitizeKernel kernel
+) {
+    size_t count = 0;
+    size_t i = 0;
+#ifdef VALUES_SANITIZE_X86
+    if constexpr (is_same_v<real, float>) {
+        if (kernel == VALUES_KERNEL_AVX2)
+            i = values_sanitize_avx2(v, size, lower, upper, step, flags, violations, count);
+        else if (kernel == VALUES_KERNEL_SSE41)
+            i = values_sanitize_sse41(v, size, lower, upper, step, flags, violations, count);
+    }
+#else
+    (void)kernel;
+#endif
+    for (; i < size; i++)
+        if (!values_sanitize_scalar(v[i], lower[i], upper[i], step[i], flags[i])) {
+            count++;
+            if (violations) violations->push_back(i);
+        }
+    return count;
+}
+
+// Same with the widest kernel the CPU runs (AVX2 or SSE4.1 for float),
+// simd = false forces the scalar one
+template<typename real>
+size_t values_sanitize(
+    real* v, size_t size,
+    const real* lower, const real* upper, const real* step, const uint8_t* flags,
+    vector<size_t>* violations = nullptr,
+    bool simd = true
+) {
+    return values_sanitize(v, size, lower, upper, step, flags, violations, simd ? values_sanitize_kernel() : VALUES_KERNEL_SCALAR);
+}